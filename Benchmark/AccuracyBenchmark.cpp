@@ -0,0 +1,99 @@
+#include "AccuracyBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "HoughTransform.h"
+
+using namespace std;
+
+AccuracyBenchmark::AccuracyBenchmark(const int scenes, const int numOfThreads) :
+	scenes(max(1, scenes)), numOfThreads(numOfThreads)
+{
+}
+
+void AccuracyBenchmark::run(const size_t w, const size_t h, const string &size, const SceneParameters &scene)
+{
+	// every front end and mode sees the same scenes
+	SyntheticLines generator(scene);
+	vector<Image<unsigned char>> images;
+	vector<vector<array<double, 4>>> truth;
+	for (int i = 0; i < scenes; i++)
+	{
+		images.push_back(generator.render(w, h));
+		truth.push_back(generator.segments);
+	}
+
+	const HoughTransform::FrontEnd frontEnds[] = { HoughTransform::ReferenceFilters, HoughTransform::FusedFilters,
+		HoughTransform::IntegerFilters, HoughTransform::StreamingFilters };
+	const char *frontEndNames[] = { "reference", "fused", "integer", "streaming" };
+	const char *modeNames[] = { "full", "gradient" };
+
+	for (int f = 0; f < 4; f++)
+		for (int m = 0; m < 2; m++)
+		{
+			HoughTransform H(w, h);
+			H.setNumThreads(numOfThreads);
+			H.setFrontEnd(frontEnds[f]);
+			const HoughTransform::VotingMode mode = (HoughTransform::VotingMode)m;
+
+			// warm up on the first scene
+			H.process(images[0].view(), scene.numOfSegments, 20, 40, mode);
+
+			LineScore score;
+			vector<double> samples;
+			for (int i = 0; i < scenes; i++)
+			{
+				const auto start = chrono::steady_clock::now();
+				H.process(images[i].view(), scene.numOfSegments, 20, 40, mode);
+				samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+				score += scoreLines(H.lines, truth[i]);
+			}
+			sort(samples.begin(), samples.end());
+
+			AccuracyResult r;
+			r.frontEnd = frontEndNames[f];
+			r.mode = modeNames[m];
+			r.size = size;
+			r.width = w;
+			r.height = h;
+			r.scene = scene;
+			r.scenes = scenes;
+			r.recall = score.recall();
+			r.precision = score.precision();
+			r.endpointError = score.endpointError();
+			r.median = samples[samples.size() / 2];
+			r.p99 = samples[(size_t)ceil(0.99 * samples.size()) - 1];
+			r.mpixelPerSecond = w * h / r.median * 1e-6;
+			results.push_back(r);
+		}
+}
+
+void AccuracyBenchmark::writeCsv(ostream &out) const
+{
+	out << "frontEnd,mode,size,width,height,segments,noise,clutter,blur,scenes,recall,precision,endpointError,"
+		"median,p99,mpixelPerSecond\n";
+	for (const auto &r : results)
+		out << r.frontEnd << "," << r.mode << "," << r.size << "," << r.width << "," << r.height << ","
+			<< r.scene.numOfSegments << "," << r.scene.noise << "," << r.scene.clutter << "," << r.scene.blur << ","
+			<< r.scenes << "," << r.recall << "," << r.precision << "," << r.endpointError << ","
+			<< r.median << "," << r.p99 << "," << r.mpixelPerSecond << "\n";
+}
+
+void AccuracyBenchmark::writeJson(ostream &out) const
+{
+	out << "[\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const auto &r = results[i];
+		out << "  {\"frontEnd\": \"" << r.frontEnd << "\", \"mode\": \"" << r.mode << "\", \"size\": \"" << r.size
+			<< "\", \"width\": " << r.width << ", \"height\": " << r.height
+			<< ", \"segments\": " << r.scene.numOfSegments << ", \"noise\": " << r.scene.noise
+			<< ", \"clutter\": " << r.scene.clutter << ", \"blur\": " << r.scene.blur << ", \"scenes\": " << r.scenes
+			<< ", \"recall\": " << r.recall << ", \"precision\": " << r.precision
+			<< ", \"endpointError\": " << r.endpointError << ", \"median\": " << r.median << ", \"p99\": " << r.p99
+			<< ", \"mpixelPerSecond\": " << r.mpixelPerSecond << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "]\n";
+}
@@ -0,0 +1,51 @@
+#ifndef _ACCURACYBENCHMARK_H
+#define _ACCURACYBENCHMARK_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "SyntheticLines.h"
+
+using std::string;
+using std::vector;
+
+// accuracy and speed of HoughLines with one front end and voting mode on the scenes of one kind
+struct AccuracyResult
+{
+	string frontEnd;
+	string mode;
+	string size;
+	size_t width;
+	size_t height;
+	SceneParameters scene;
+	int scenes;
+	double recall;
+	double precision;
+	double endpointError;	// pixels
+	double median;			// seconds of HoughLines
+	double p99;
+	double mpixelPerSecond;	// of the median
+};
+
+// runs HoughLines with every front end and voting mode on synthetic scenes and scores the
+// segments against the ground truth, so faster modes can be judged by what they lose
+class AccuracyBenchmark
+{
+public:
+	AccuracyBenchmark(const int scenes = 10, const int numOfThreads = 1);
+
+	// scenes of w x h pixels named size, numOfSegments lines are searched for
+	void run(const size_t w, const size_t h, const string &size, const SceneParameters &scene);
+
+	void writeCsv(std::ostream &out) const;
+	void writeJson(std::ostream &out) const;
+
+	vector<AccuracyResult> results;
+
+private:
+	const int scenes;
+	const int numOfThreads;
+};
+
+#endif
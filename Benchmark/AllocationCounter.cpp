@@ -0,0 +1,32 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+static atomic<long> allocations(0);
+
+void *operator new(size_t bytes)
+{
+	allocations++;
+	if (void *p = malloc(bytes > 0 ? bytes : 1))
+		return p;
+	throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+long allocationCount()
+{
+	return allocations;
+}
@@ -0,0 +1,9 @@
+#ifndef _ALLOCATIONCOUNTER_H
+#define _ALLOCATIONCOUNTER_H
+
+// AllocationCounter.cpp replaces the global operator new and delete of the program it is
+// linked into with ones counting every allocation, so steady state allocations show up
+
+long allocationCount();	// number of operator new calls of the program so far
+
+#endif
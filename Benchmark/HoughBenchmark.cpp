@@ -0,0 +1,142 @@
+#include "HoughBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "AllocationCounter.h"
+
+using namespace std;
+
+HoughBenchmark::HoughBenchmark(const int repeats, const int numOfThreads) :
+	repeats(max(1, repeats)), numOfThreads(numOfThreads), width(0), height(0), edges(0)
+{
+	samples.reserve(this->repeats);
+}
+
+template <typename F>
+void HoughBenchmark::measure(const string &stage, const string &frontEnd, const int numOfLines, F f)
+{
+	f();
+
+	samples.clear();
+	const long allocs = allocationCount();
+	for (int i = 0; i < repeats; i++)
+	{
+		const auto start = chrono::steady_clock::now();
+		f();
+		samples.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+	}
+	const long runAllocs = allocationCount() - allocs;
+	sort(samples.begin(), samples.end());
+
+	BenchmarkResult r;
+	r.stage = stage;
+	r.frontEnd = frontEnd;
+	r.size = size;
+	r.density = density;
+	r.width = width;
+	r.height = height;
+	r.numOfLines = numOfLines;
+	r.repeats = repeats;
+	r.median = samples[samples.size() / 2];
+	// nearest rank, the slowest run for fewer than 100 repeats
+	r.p99 = samples[(size_t)ceil(0.99 * samples.size()) - 1];
+	r.mpixelPerSecond = width * height / r.median * 1e-6;
+	r.allocations = (double)runAllocs / repeats;
+	r.edges = edges;
+	results.push_back(r);
+}
+
+void HoughBenchmark::run(const ImageView<const unsigned char> &image, const string &size, const string &density,
+	const vector<int> &numOfLines)
+{
+	this->size = size;
+	this->density = density;
+	width = image.width;
+	height = image.height;
+
+	HoughTransform H(width, height);
+	H.setNumThreads(numOfThreads);
+	H.img = image;
+
+	// edges of the default front end, used by the stages after suppression
+	H.findEdges();
+	edges = H.edgeCount();
+
+	// front end stages, each front end needs its planes first
+	H.setFrontEnd(HoughTransform::ReferenceFilters);
+	measure("GaussianFilter", "reference", 0, [&] { H.GaussianFilter(); });
+	measure("SobelEdge", "reference", 0, [&] { H.SobelEdge(); });
+	measure("NonMaxSuppression", "reference", 0, [&] { H.NonMaxSuppression(); });
+	H.setFrontEnd(HoughTransform::IntegerFilters);
+	measure("GaussianSobelInt", "integer", 0, [&] { H.GaussianSobelInt(); });
+	measure("NonMaxSuppressionInt", "integer", 0, [&] { H.NonMaxSuppressionInt(); });
+	H.setFrontEnd(HoughTransform::FusedFilters);
+	measure("GaussianSobel", "fused", 0, [&] { H.GaussianSobel(); });
+	H.NonMaxSuppression();
+
+	// back end stages on the edges of the fused front end
+	const Rect all{ 0, 0, (int)width, (int)height };
+	unsigned int hist[256] = {};
+	unsigned char high, low;
+	measure("histogram", "fused", 0, [&]
+	{
+		fill(hist, hist + 256, 0);
+		H.addHistogram(hist, all);
+		HoughTransform::edgeThresholds(hist, high, low);
+	});
+	measure("threshold", "fused", 0, [&] { H.thresholdEdges(high, low, all); });
+	// voting as in HoughLines, by numOfThreads threads
+	measure("vote", "fused", 0, [&] { H.voteMatrix(HoughTransform::FullVoting, 10); });
+	measure("gradientVote", "fused", 0, [&] { H.voteMatrix(HoughTransform::GradientVoting, 10); });
+
+	// keep the full voting matrix for the peaks
+	H.voteMatrix(HoughTransform::FullVoting, 10);
+	for (const int n : numOfLines)
+	{
+		measure("HoughPeaks", "fused", n, [&] { H.HoughPeaks(n); });
+		measure("segments", "fused", n, [&]
+		{
+			H.lines.clear();
+			H.segments.index(H.edges, H.peaks, H.trig, (H.rRange - 1) / 2);
+			H.segments.extract(H.edges, 5, 60, 0, 0, H.lines);
+		});
+	}
+
+	// end to end, every front end
+	const HoughTransform::FrontEnd frontEnds[] = { HoughTransform::ReferenceFilters, HoughTransform::FusedFilters,
+		HoughTransform::IntegerFilters, HoughTransform::StreamingFilters };
+	const char *names[] = { "reference", "fused", "integer", "streaming" };
+	for (int k = 0; k < 4; k++)
+	{
+		H.setFrontEnd(frontEnds[k]);
+		for (const int n : numOfLines)
+			measure("HoughLines", names[k], n, [&] { H.HoughLines(n, 5, 60); });
+	}
+}
+
+void HoughBenchmark::writeCsv(ostream &out) const
+{
+	out << "stage,frontEnd,size,density,width,height,numOfLines,repeats,median,p99,mpixelPerSecond,allocations,edges\n";
+	for (const auto &r : results)
+		out << r.stage << "," << r.frontEnd << "," << r.size << "," << r.density << "," << r.width << ","
+			<< r.height << "," << r.numOfLines << "," << r.repeats << "," << r.median << "," << r.p99 << ","
+			<< r.mpixelPerSecond << "," << r.allocations << "," << r.edges << "\n";
+}
+
+void HoughBenchmark::writeJson(ostream &out) const
+{
+	out << "[\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const auto &r = results[i];
+		out << "  {\"stage\": \"" << r.stage << "\", \"frontEnd\": \"" << r.frontEnd << "\", \"size\": \"" << r.size
+			<< "\", \"density\": \"" << r.density << "\", \"width\": " << r.width << ", \"height\": " << r.height
+			<< ", \"numOfLines\": " << r.numOfLines << ", \"repeats\": " << r.repeats << ", \"median\": " << r.median
+			<< ", \"p99\": " << r.p99 << ", \"mpixelPerSecond\": " << r.mpixelPerSecond
+			<< ", \"allocations\": " << r.allocations << ", \"edges\": " << r.edges << "}"
+			<< (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "]\n";
+}
@@ -0,0 +1,66 @@
+#ifndef _HOUGHBENCHMARK_H
+#define _HOUGHBENCHMARK_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "HoughTransform.h"
+#include "Image.h"
+
+using std::string;
+using std::vector;
+
+// timing of one stage on one image, over repeats runs after a warm-up run
+struct BenchmarkResult
+{
+	string stage;
+	string frontEnd;
+	string size;		// name of the image size, such as vga or 4k
+	string density;		// name of the edge density of the image
+	size_t width;
+	size_t height;
+	int numOfLines;		// lines searched for, 0 for stages before the peaks
+	int repeats;
+	double median;		// seconds
+	double p99;
+	double mpixelPerSecond;	// of the median
+	double allocations;		// operator new calls per run
+	size_t edges;		// edge pixels found in the image
+};
+
+// runs every stage of HoughTransform on its own and HoughLines of every front end,
+// and writes the timings as CSV or JSON for tracking them across releases
+class HoughBenchmark
+{
+public:
+	HoughBenchmark(const int repeats = 15, const int numOfThreads = 1);
+
+	// benchmark image, named size x density, searching for each of numOfLines lines
+	void run(const ImageView<const unsigned char> &image, const string &size, const string &density,
+		const vector<int> &numOfLines);
+
+	void writeCsv(std::ostream &out) const;
+	void writeJson(std::ostream &out) const;
+
+	vector<BenchmarkResult> results;
+
+private:
+	// time f, called repeats times after one warm-up call
+	template <typename F>
+	void measure(const string &stage, const string &frontEnd, const int numOfLines, F f);
+
+	const int repeats;
+	const int numOfThreads;
+
+	// the image of the current run
+	string size;
+	string density;
+	size_t width;
+	size_t height;
+	size_t edges;
+
+	vector<double> samples;
+};
+
+#endif
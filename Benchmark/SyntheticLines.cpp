@@ -0,0 +1,216 @@
+#include "SyntheticLines.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const double PI = 3.14159265358979;
+
+SyntheticLines::SyntheticLines(const SceneParameters &parameters, const unsigned seed) :
+	parameters(parameters), random(seed)
+{
+}
+
+Image<unsigned char> SyntheticLines::render(const size_t w, const size_t h)
+{
+	// segments stay clear of the border, where the filters find no edges
+	const double margin = 8;
+	const double maxLength = max((double)parameters.minLength,
+		parameters.maxLength > 0 ? parameters.maxLength : 0.5 * sqrt((double)(w*w + h*h)));
+	uniform_real_distribution<double> u(0, 1);
+	vector<float> plane(w*h, (float)parameters.background);
+
+	segments.clear();
+	for (int i = 0, tries = 0; i < parameters.numOfSegments && tries < 1000 * parameters.numOfSegments; tries++)
+	{
+		const double length = parameters.minLength + u(random) * (maxLength - parameters.minLength);
+		const double angle = u(random) * PI;
+		const double cx = margin + u(random) * (w - 1 - 2 * margin);
+		const double cy = margin + u(random) * (h - 1 - 2 * margin);
+		const double dx = 0.5 * length * cos(angle);
+		const double dy = 0.5 * length * sin(angle);
+		const array<double, 4> s = { cx - dx, cy - dy, cx + dx, cy + dy };
+		if (min(s[0], s[2]) < margin || max(s[0], s[2]) > w - 1 - margin ||
+			min(s[1], s[3]) < margin || max(s[1], s[3]) > h - 1 - margin)
+			continue;
+
+		drawSegment(plane, w, h, s, parameters.thickness, (float)parameters.contrast);
+		segments.push_back(s);
+		i++;
+	}
+
+	// clutter: strokes too short to be detected and blobs, half of them darker than the background
+	for (int i = 0; i < parameters.clutter; i++)
+	{
+		const float intensity = (float)(u(random) < 0.5 ? parameters.contrast : -parameters.contrast / 2);
+		const double cx = u(random) * (w - 1);
+		const double cy = u(random) * (h - 1);
+		if (u(random) < 0.5)
+		{
+			const double length = u(random) * parameters.minLength / 3;
+			const double angle = u(random) * PI;
+			const double dx = 0.5 * length * cos(angle);
+			const double dy = 0.5 * length * sin(angle);
+			drawSegment(plane, w, h, { cx - dx, cy - dy, cx + dx, cy + dy }, parameters.thickness, intensity);
+		}
+		else
+			drawSegment(plane, w, h, { cx, cy, cx, cy }, 2 + u(random) * 10, intensity);
+	}
+
+	if (parameters.blur > 0)
+		gaussianBlur(plane, w, h, parameters.blur);
+
+	normal_distribution<float> noise(0, (float)parameters.noise);
+	Image<unsigned char> image(w, h);
+	for (size_t y = 0; y < h; y++)
+		for (size_t x = 0; x < w; x++)
+		{
+			const float v = plane[y*w + x] + (parameters.noise > 0 ? noise(random) : 0);
+			image.pixels[y*image.stride + x] = (unsigned char)min(255.0f, max(0.0f, round(v)));
+		}
+	return image;
+}
+
+void SyntheticLines::drawSegment(vector<float> &plane, const size_t w, const size_t h, const array<double, 4> &s,
+	const double thickness, const float intensity)
+{
+	// pixels are visited along the major axis of the segment, a few pixels on each side of it
+	const double r = 0.5 * thickness + 0.5;
+	const double dx = s[2] - s[0];
+	const double dy = s[3] - s[1];
+	const double length2 = dx*dx + dy*dy;
+	const bool alongX = fabs(dx) >= fabs(dy);
+	const double major = max(fabs(dx), fabs(dy));
+	const int span = (int)ceil(major > 0 ? r * sqrt(length2) / major : r) + 1;
+	const int n = alongX ? (int)w : (int)h;
+	const int m = alongX ? (int)h : (int)w;
+	const double a0 = alongX ? s[0] : s[1];
+	const double a1 = alongX ? s[2] : s[3];
+	const int i0 = max(0, (int)floor(min(a0, a1) - r));
+	const int i1 = min(n - 1, (int)ceil(max(a0, a1) + r));
+
+	for (int i = i0; i <= i1; i++)
+	{
+		// the segment crosses row or column i at c, clamped to its ends
+		const double t = major > 0 ? max(0.0, min(1.0, (i - a0) / (a1 - a0))) : 0;
+		const double c = alongX ? s[1] + t*dy : s[0] + t*dx;
+		const int j0 = max(0, (int)floor(c) - span);
+		const int j1 = min(m - 1, (int)ceil(c) + span);
+		for (int j = j0; j <= j1; j++)
+		{
+			const int x = alongX ? i : j;
+			const int y = alongX ? j : i;
+			// distance of the pixel centre to the segment, the coverage falls off over one pixel
+			const double u = length2 > 0 ? max(0.0, min(1.0, ((x - s[0])*dx + (y - s[1])*dy) / length2)) : 0;
+			const double d = hypot(x - s[0] - u*dx, y - s[1] - u*dy);
+			const double coverage = min(1.0, max(0.0, r - d));
+			plane[y*w + x] += (float)(coverage * intensity);
+		}
+	}
+}
+
+void SyntheticLines::gaussianBlur(vector<float> &plane, const size_t w, const size_t h, const double sigma)
+{
+	// separable convolution, borders replicated
+	const int radius = (int)ceil(3 * sigma);
+	vector<float> kernel(2 * radius + 1);
+	float sum = 0;
+	for (int i = -radius; i <= radius; i++)
+		sum += kernel[i + radius] = (float)exp(-0.5 * i * i / (sigma * sigma));
+	for (auto &k : kernel)
+		k /= sum;
+
+	vector<float> tmp(w*h);
+	for (size_t y = 0; y < h; y++)
+		for (size_t x = 0; x < w; x++)
+		{
+			float v = 0;
+			for (int i = -radius; i <= radius; i++)
+				v += kernel[i + radius] * plane[y*w + min(w - 1, (size_t)max(0, (int)x + i))];
+			tmp[y*w + x] = v;
+		}
+	for (size_t y = 0; y < h; y++)
+		for (size_t x = 0; x < w; x++)
+		{
+			float v = 0;
+			for (int i = -radius; i <= radius; i++)
+				v += kernel[i + radius] * tmp[min(h - 1, (size_t)max(0, (int)y + i))*w + x];
+			plane[y*w + x] = v;
+		}
+}
+
+LineScore &LineScore::operator+=(const LineScore &s)
+{
+	truth += s.truth;
+	detected += s.detected;
+	found += s.found;
+	correct += s.correct;
+	endpointErrorSum += s.endpointErrorSum;
+	return *this;
+}
+
+// d lies on t: parallel within maxAngle degrees, both endpoints within maxDistance of t
+static bool liesOn(const array<int, 4> &d, const array<double, 4> &t, const double maxDistance, const double maxAngle)
+{
+	const double tx = t[2] - t[0];
+	const double ty = t[3] - t[1];
+	const double length = hypot(tx, ty);
+	if (length == 0)
+		return false;
+
+	double angle = fabs(atan2((double)d[3] - d[1], (double)d[2] - d[0]) - atan2(ty, tx)) * 180 / PI;
+	angle = fmod(angle, 180.0);
+	if (min(angle, 180 - angle) > maxAngle)
+		return false;
+
+	for (int k = 0; k < 4; k += 2)
+	{
+		const double px = d[k] - t[0];
+		const double py = d[k + 1] - t[1];
+		const double along = (px*tx + py*ty) / length;
+		const double across = fabs(px*ty - py*tx) / length;
+		if (across > maxDistance || along < -maxDistance || along > length + maxDistance)
+			return false;
+	}
+	return true;
+}
+
+// mean distance of the endpoints of d to those of t, in the order that fits best
+static double endpointDistance(const array<int, 4> &d, const array<double, 4> &t)
+{
+	const double same = hypot(d[0] - t[0], d[1] - t[1]) + hypot(d[2] - t[2], d[3] - t[3]);
+	const double swapped = hypot(d[0] - t[2], d[1] - t[3]) + hypot(d[2] - t[0], d[3] - t[1]);
+	return 0.5 * min(same, swapped);
+}
+
+LineScore scoreLines(const vector<array<int, 4>> &detected, const vector<array<double, 4>> &truth,
+	const double maxDistance, const double maxAngle)
+{
+	LineScore score;
+	score.truth = (int)truth.size();
+	score.detected = (int)detected.size();
+
+	vector<double> best(truth.size(), -1);
+	for (const auto &d : detected)
+	{
+		bool correct = false;
+		for (size_t k = 0; k < truth.size(); k++)
+			if (liesOn(d, truth[k], maxDistance, maxAngle))
+			{
+				correct = true;
+				const double e = endpointDistance(d, truth[k]);
+				if (best[k] < 0 || e < best[k])
+					best[k] = e;
+			}
+		score.correct += correct;
+	}
+
+	for (const double e : best)
+		if (e >= 0)
+		{
+			score.found++;
+			score.endpointErrorSum += e;
+		}
+	return score;
+}
@@ -0,0 +1,74 @@
+#ifndef _SYNTHETICLINES_H
+#define _SYNTHETICLINES_H
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include "Image.h"
+
+using std::array;
+using std::vector;
+
+// scenes rendered by SyntheticLines
+struct SceneParameters
+{
+	int numOfSegments = 10;
+	int minLength = 80;		// pixels
+	int maxLength = 0;		// pixels, 0 for half the image diagonal
+	double thickness = 2;
+	int background = 90;
+	int contrast = 80;		// segments are background + contrast
+	double noise = 2;		// standard deviation of gaussian noise
+	int clutter = 0;		// short strokes and blobs that are not part of the ground truth
+	double blur = 0;		// sigma of a gaussian blur, 0 for none
+};
+
+// images with known line segments: anti-aliased segments, clutter, blur and noise on a
+// flat background. the same seed renders the same scenes.
+class SyntheticLines
+{
+public:
+	SyntheticLines(const SceneParameters &parameters = SceneParameters(), const unsigned seed = 1);
+
+	// render the next scene of w x h pixels, its segments are stored in segments
+	Image<unsigned char> render(const size_t w, const size_t h);
+
+	const SceneParameters parameters;
+
+	// ground truth of the last scene as [x1, y1, x2, y2], pixel centres at integer coordinates
+	vector<array<double, 4>> segments;
+
+private:
+	// add intensity to the pixels within thickness / 2 of the segment, with a one pixel ramp
+	static void drawSegment(vector<float> &plane, const size_t w, const size_t h, const array<double, 4> &s,
+		const double thickness, const float intensity);
+	static void gaussianBlur(vector<float> &plane, const size_t w, const size_t h, const double sigma);
+
+	std::mt19937 random;
+};
+
+// detected segments scored against the ground truth. a detection is correct if it is parallel to a
+// segment within maxAngle degrees and lies on it within maxDistance pixels; a segment is found if
+// one detection is correct for it. the endpoint error of a found segment is the mean distance of the
+// endpoints of its best detection, so fragmented detections score worse than whole ones.
+// scores of several scenes are summed with +=.
+struct LineScore
+{
+	int truth = 0;			// segments of the ground truth
+	int detected = 0;		// segments detected
+	int found = 0;			// ground truth segments with a correct detection
+	int correct = 0;		// detections lying on a ground truth segment
+	double endpointErrorSum = 0;	// of the found segments
+
+	double recall() const { return truth > 0 ? (double)found / truth : 1; }
+	double precision() const { return detected > 0 ? (double)correct / detected : 1; }
+	double endpointError() const { return found > 0 ? endpointErrorSum / found : 0; }
+
+	LineScore &operator+=(const LineScore &s);
+};
+
+LineScore scoreLines(const vector<array<int, 4>> &detected, const vector<array<double, 4>> &truth,
+	const double maxDistance = 3, const double maxAngle = 2);
+
+#endif
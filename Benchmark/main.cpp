@@ -0,0 +1,180 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "AccuracyBenchmark.h"
+#include "HoughBenchmark.h"
+#include "SyntheticLines.h"
+
+using namespace std;
+
+// Benchmark [--format csv|json] [--output file] [--sizes vga,hd,...] [--densities low,...]
+//           [--lines 1,10,...] [--repeats n] [--threads n]
+// Benchmark --accuracy [--format csv|json] [--output file] [--sizes vga,...] [--scenes n] [--threads n]
+// sizes: vga, hd, fullhd, 4k, 8k. densities: low, medium, high
+// the first form times every stage, the second scores HoughLines against synthetic scenes
+// of several noise, clutter and blur levels
+
+struct NamedSize { const char *name; size_t width; size_t height; };
+static const NamedSize sizes[] = {
+	{ "vga", 640, 480 }, { "hd", 1280, 720 }, { "fullhd", 1920, 1080 }, { "4k", 3840, 2160 }, { "8k", 7680, 4320 } };
+
+// random segments per megapixel of every density
+struct NamedDensity { const char *name; int linesPerMpixel; };
+static const NamedDensity densities[] = { { "low", 8 }, { "medium", 64 }, { "high", 512 } };
+
+static vector<string> split(const string &list)
+{
+	vector<string> items;
+	stringstream s(list);
+	string item;
+	while (getline(s, item, ','))
+		items.push_back(item);
+	return items;
+}
+
+int main(int argc, char *argv[])
+{
+	string format = "csv";
+	string output;
+	vector<string> sizeNames = { "vga", "hd", "fullhd", "4k", "8k" };
+	vector<string> densityNames = { "low", "medium", "high" };
+	vector<int> numOfLines = { 1, 10, 100 };
+	int repeats = 15;
+	int threads = 1;
+	bool accuracy = false;
+	bool sizesGiven = false;
+	int scenes = 10;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const string arg = argv[i];
+		if (arg == "--accuracy")
+		{
+			accuracy = true;
+			continue;
+		}
+		if (i + 1 == argc)
+		{
+			cerr << "missing value of " << arg << endl;
+			return 1;
+		}
+		const string value = argv[++i];
+		if (arg == "--format")
+			format = value;
+		else if (arg == "--output")
+			output = value;
+		else if (arg == "--sizes")
+		{
+			sizeNames = split(value);
+			sizesGiven = true;
+		}
+		else if (arg == "--densities")
+			densityNames = split(value);
+		else if (arg == "--lines")
+		{
+			numOfLines.clear();
+			for (const auto &n : split(value))
+				numOfLines.push_back(atoi(n.c_str()));
+		}
+		else if (arg == "--repeats")
+			repeats = atoi(value.c_str());
+		else if (arg == "--threads")
+			threads = atoi(value.c_str());
+		else if (arg == "--scenes")
+			scenes = atoi(value.c_str());
+		else
+		{
+			cerr << "unknown option " << arg << endl;
+			return 1;
+		}
+	}
+	if (format != "csv" && format != "json")
+	{
+		cerr << "unknown format " << format << endl;
+		return 1;
+	}
+
+	// scenes are scored at vga unless other sizes are given
+	if (accuracy && !sizesGiven)
+		sizeNames = { "vga" };
+
+	HoughBenchmark benchmark(repeats, threads);
+	AccuracyBenchmark accuracyBenchmark(scenes, threads);
+	for (const auto &sizeName : sizeNames)
+	{
+		const NamedSize *size = nullptr;
+		for (const auto &s : sizes)
+			if (sizeName == s.name)
+				size = &s;
+		if (size == nullptr)
+		{
+			cerr << "unknown size " << sizeName << endl;
+			return 1;
+		}
+
+		if (accuracy)
+		{
+			for (const double noise : { 2.0, 8.0, 16.0 })
+				for (const int clutter : { 0, 100 })
+					for (const double blur : { 0.0, 1.5 })
+					{
+						SceneParameters scene;
+						scene.noise = noise;
+						scene.clutter = clutter;
+						scene.blur = blur;
+						cerr << size->name << " noise " << noise << " clutter " << clutter << " blur " << blur << endl;
+						accuracyBenchmark.run(size->width, size->height, size->name, scene);
+					}
+			continue;
+		}
+
+		for (const auto &densityName : densityNames)
+		{
+			const NamedDensity *density = nullptr;
+			for (const auto &d : densities)
+				if (densityName == d.name)
+					density = &d;
+			if (density == nullptr)
+			{
+				cerr << "unknown density " << densityName << endl;
+				return 1;
+			}
+
+			SceneParameters scene;
+			scene.numOfSegments = (int)(density->linesPerMpixel * size->width * size->height / 1000000) + 1;
+			scene.minLength = 40;
+			scene.maxLength = 400;
+			SyntheticLines generator(scene);
+			const Image<unsigned char> image = generator.render(size->width, size->height);
+			cerr << size->name << " " << density->name << endl;
+			benchmark.run(image.view(), size->name, density->name, numOfLines);
+		}
+	}
+
+	ofstream file;
+	if (!output.empty())
+	{
+		file.open(output);
+		if (!file)
+		{
+			cerr << "can not write " << output << endl;
+			return 1;
+		}
+	}
+	ostream &out = output.empty() ? cout : file;
+	if (accuracy)
+	{
+		if (format == "json")
+			accuracyBenchmark.writeJson(out);
+		else
+			accuracyBenchmark.writeCsv(out);
+	}
+	else if (format == "json")
+		benchmark.writeJson(out);
+	else
+		benchmark.writeCsv(out);
+	return 0;
+}
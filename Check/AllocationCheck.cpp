@@ -0,0 +1,45 @@
+#include "Checks.h"
+
+#include "AllocationCounter.h"
+#include "HoughTransform.h"
+
+using namespace std;
+
+bool checkAllocations(ostream &log)
+{
+	// the first frames may grow the edge list, worklists and heaps
+	const int warmUp = 6;
+	const int frames = 24;
+	const vector<Image<unsigned char>> scenes = checkScenes(640, 480, 3);
+
+	const HoughTransform::FrontEnd frontEnds[] = { HoughTransform::ReferenceFilters, HoughTransform::FusedFilters,
+		HoughTransform::IntegerFilters, HoughTransform::StreamingFilters };
+	const char *frontEndNames[] = { "reference", "fused", "integer", "streaming" };
+	const HoughTransform::VotingMode modes[] = { HoughTransform::FullVoting, HoughTransform::GradientVoting };
+	const char *modeNames[] = { "full", "gradient" };
+
+	bool passed = true;
+	for (int f = 0; f < 4; f++)
+		for (const int threads : { 1, 4 })
+			for (int m = 0; m < 2; m++)
+			{
+				HoughTransform H(640, 480);
+				H.setFrontEnd(frontEnds[f]);
+				H.setNumThreads(threads);
+
+				long allocations = 0;
+				for (int k = 0; k < frames; k++)
+				{
+					const long before = allocationCount();
+					H.process(scenes[k % scenes.size()].view(), 10, 5, 40, modes[m]);
+					if (k >= warmUp)
+						allocations += allocationCount() - before;
+				}
+
+				log << "allocations " << frontEndNames[f] << " " << modeNames[m] << " threads " << threads
+					<< ": " << allocations << " after warm-up" << endl;
+				if (allocations != 0)
+					passed = false;
+			}
+	return passed;
+}
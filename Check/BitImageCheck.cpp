@@ -0,0 +1,126 @@
+#include "Checks.h"
+
+#include <random>
+#include <string>
+
+#include "BitImage.h"
+
+using namespace std;
+
+// byte per pixel image the bit images are compared with
+struct ByteImage
+{
+	size_t width, height;
+	vector<char> pixels;
+
+	ByteImage(const size_t w, const size_t h) : width(w), height(h), pixels(w * h) {}
+	char &at(const size_t x, const size_t y) { return pixels[y * width + x]; }
+	char at(const size_t x, const size_t y) const { return pixels[y * width + x]; }
+};
+
+static void randomize(ByteImage &A, BitImage &B, mt19937 &random, const unsigned density)
+{
+	B.clear();
+	for (size_t y = 0; y < A.height; y++)
+		for (size_t x = 0; x < A.width; x++)
+		{
+			A.at(x, y) = random() % 100 < density;
+			if (A.at(x, y))
+				B.set(x, y);
+		}
+}
+
+// the pixels, the count, the zero padding bits and forEach in raster order agree with A
+static bool sameImage(const ByteImage &A, const BitImage &B)
+{
+	size_t n = 0;
+	for (size_t y = 0; y < A.height; y++)
+		for (size_t x = 0; x < A.width; x++)
+		{
+			if (B.test(x, y) != (A.at(x, y) != 0))
+				return false;
+			n += A.at(x, y);
+		}
+	if (B.count() != n)
+		return false;
+
+	size_t i = 0;
+	bool ordered = true;
+	B.forEach(0, B.height, [&](const int x, const int y)
+	{
+		while (i < A.pixels.size() && !A.pixels[i])
+			i++;
+		ordered = ordered && i == (size_t)y * A.width + (size_t)x;
+		i++;
+	});
+	return ordered;
+}
+
+bool checkBitImages(ostream &log)
+{
+	mt19937 random(1);
+	bool passed = true;
+	int cases = 0;
+
+	// widths around the word size, so carries across words and the padding of the last word are covered
+	for (const size_t w : { 1, 2, 63, 64, 65, 127, 128, 129, 200 })
+		for (const size_t h : { 1, 2, 3, 17 })
+			for (const unsigned density : { 2u, 30u, 90u })
+			{
+				ByteImage A(w, h), B(w, h);
+				BitImage a(w, h), b(w, h), c(w, h);
+				randomize(A, a, random, density);
+				randomize(B, b, random, density);
+				string failed;
+
+				if (!sameImage(A, a))
+					failed += " set";
+
+				// dilate by the 3x3 square
+				c.dilate(a);
+				ByteImage D(w, h);
+				for (size_t y = 0; y < h; y++)
+					for (size_t x = 0; x < w; x++)
+						for (size_t v = (y > 0 ? y - 1 : 0); v <= y + 1 && v < h; v++)
+							for (size_t u = (x > 0 ? x - 1 : 0); u <= x + 1 && u < w; u++)
+								D.at(x, y) |= A.at(u, v);
+				if (!sameImage(D, c))
+					failed += " dilate";
+
+				ByteImage C = A;
+				for (size_t k = 0; k < C.pixels.size(); k++)
+					C.pixels[k] &= B.pixels[k];
+				c.clear();
+				c |= a;
+				c &= b;
+				if (!sameImage(C, c))
+					failed += " and";
+
+				C = A;
+				for (size_t k = 0; k < C.pixels.size(); k++)
+					C.pixels[k] |= B.pixels[k];
+				c.clear();
+				c |= a;
+				c |= b;
+				if (!sameImage(C, c))
+					failed += " or";
+
+				// clear the rows of the middle third
+				for (size_t y = h / 3; y < 2 * h / 3; y++)
+					for (size_t x = 0; x < w; x++)
+						C.at(x, y) = 0;
+				c.clearRows(h / 3, 2 * h / 3);
+				if (!sameImage(C, c))
+					failed += " clearRows";
+
+				if (!failed.empty())
+				{
+					log << "bit images " << w << " x " << h << " density " << density << "%:" << failed << " differ" << endl;
+					passed = false;
+				}
+				cases++;
+			}
+
+	log << "bit images: set, count, forEach, dilate, and, or and clearRows of " << cases << " images compared" << endl;
+	return passed;
+}
@@ -0,0 +1,33 @@
+#ifndef _CHECKS_H
+#define _CHECKS_H
+
+#include <ostream>
+#include <vector>
+
+#include "Image.h"
+
+using std::vector;
+
+// invariants of HoughTransform that the benchmarks do not cover. every check writes
+// what it tested to log and returns false if the invariant does not hold.
+
+// count different scenes of w x h pixels from SyntheticLines, the same on every call
+vector<Image<unsigned char>> checkScenes(const size_t w, const size_t h, const int count);
+
+// process allocates nothing once the first frames have grown the workspace, with every
+// front end, voting mode and number of threads, on frames alternating between scenes
+bool checkAllocations(std::ostream &log);
+
+// the voting matrix and the lines are the same with 1 and 4 threads, with every front end,
+// voting mode and matrix layout. streaming votes serially, only its peak search is parallel
+bool checkParallelVoting(std::ostream &log);
+
+// every vectorised filter kernel the CPU supports gives the same bits as the scalar kernels,
+// at all widths around the vector sizes, and the front ends the same lines
+bool checkKernels(std::ostream &log);
+
+// the word-parallel operations of BitImage give the same pixels as pixel by pixel operations,
+// at widths around the word size
+bool checkBitImages(std::ostream &log);
+
+#endif
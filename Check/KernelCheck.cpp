@@ -0,0 +1,182 @@
+#include "Checks.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "Filters.h"
+#include "HoughTransform.h"
+
+using namespace std;
+
+template <typename T>
+static bool same(const vector<T> &a, const vector<T> &b)
+{
+	// bitwise, so NaN slopes of flat pixels compare too
+	return memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+// outputs of every kernel for one set of input rows
+struct KernelOutputs
+{
+	vector<float> gaussianRow, gaussianColumn, sobelG1, sobelG2, amp, slope;
+	vector<short> gaussianRowInt, gaussianColumnInt, sobelG1Int, sobelG2Int, ampInt, gxInt, gyInt;
+
+	KernelOutputs(const int w) :
+		gaussianRow(w), gaussianColumn(w), sobelG1(w), sobelG2(w), amp(w), slope(w),
+		gaussianRowInt(w), gaussianColumnInt(w), sobelG1Int(w), sobelG2Int(w), ampInt(w), gxInt(w), gyInt(w)
+	{
+	}
+};
+
+// the inputs of every kernel are the scalar outputs of the kernel before it, so a difference
+// shows up at the kernel causing it
+struct KernelInputs
+{
+	vector<vector<unsigned char>> pixels;	// 5 rows
+	vector<vector<float>> filtered;			// 5 horizontally filtered rows
+	vector<vector<float>> smooth, g1, g2;	// 3 rows
+	vector<vector<short>> filteredInt, smoothInt, g1Int, g2Int;
+
+	KernelInputs(const int w, mt19937 &random) :
+		pixels(5, vector<unsigned char>(w)), filtered(5, vector<float>(w)),
+		smooth(3, vector<float>(w)), g1(3, vector<float>(w)), g2(3, vector<float>(w)),
+		filteredInt(5, vector<short>(w)), smoothInt(3, vector<short>(w)), g1Int(3, vector<short>(w)), g2Int(3, vector<short>(w))
+	{
+		// noise with flat runs, where gradients are zero and slopes are 0 / 0
+		for (auto &row : pixels)
+			for (int j = 0; j < w; j++)
+				row[j] = (j / 8) % 3 == 0 ? 128 : (unsigned char)(random() & 255);
+
+		for (int k = 0; k < 5; k++)
+		{
+			gaussianRow(pixels[k].data(), filtered[k].data(), w);
+			gaussianRowInt(pixels[k].data(), filteredInt[k].data(), w);
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			// smoothed rows of different windows of the pixel rows
+			const float *rows[5] = { filtered[k].data(), filtered[(k + 1) % 5].data(), filtered[(k + 2) % 5].data(),
+				filtered[(k + 3) % 5].data(), filtered[(k + 4) % 5].data() };
+			gaussianColumn(rows, smooth[k].data(), w);
+			const short *rowsInt[5] = { filteredInt[k].data(), filteredInt[(k + 1) % 5].data(), filteredInt[(k + 2) % 5].data(),
+				filteredInt[(k + 3) % 5].data(), filteredInt[(k + 4) % 5].data() };
+			gaussianColumnInt(rowsInt, smoothInt[k].data(), w);
+			sobelRow(smooth[k].data(), g1[k].data(), g2[k].data(), w);
+			sobelRowInt(smoothInt[k].data(), g1Int[k].data(), g2Int[k].data(), w);
+		}
+	}
+};
+
+static void runKernels(const KernelInputs &in, KernelOutputs &out, const int w)
+{
+	gaussianRow(in.pixels[0].data(), out.gaussianRow.data(), w);
+	const float *rows[5] = { in.filtered[0].data(), in.filtered[1].data(), in.filtered[2].data(),
+		in.filtered[3].data(), in.filtered[4].data() };
+	gaussianColumn(rows, out.gaussianColumn.data(), w);
+	sobelRow(in.smooth[0].data(), out.sobelG1.data(), out.sobelG2.data(), w);
+	const float *g1[3] = { in.g1[0].data(), in.g1[1].data(), in.g1[2].data() };
+	const float *g2[3] = { in.g2[0].data(), in.g2[1].data(), in.g2[2].data() };
+	sobelColumn(g1, g2, out.amp.data(), out.slope.data(), w);
+
+	gaussianRowInt(in.pixels[0].data(), out.gaussianRowInt.data(), w);
+	const short *rowsInt[5] = { in.filteredInt[0].data(), in.filteredInt[1].data(), in.filteredInt[2].data(),
+		in.filteredInt[3].data(), in.filteredInt[4].data() };
+	gaussianColumnInt(rowsInt, out.gaussianColumnInt.data(), w);
+	sobelRowInt(in.smoothInt[0].data(), out.sobelG1Int.data(), out.sobelG2Int.data(), w);
+	const short *g1Int[3] = { in.g1Int[0].data(), in.g1Int[1].data(), in.g1Int[2].data() };
+	const short *g2Int[3] = { in.g2Int[0].data(), in.g2Int[1].data(), in.g2Int[2].data() };
+	sobelColumnInt(g1Int, g2Int, out.ampInt.data(), out.gxInt.data(), out.gyInt.data(), w);
+}
+
+// names of the kernels whose outputs differ
+static string differences(const KernelOutputs &a, const KernelOutputs &b)
+{
+	string names;
+	auto check = [&](const bool equal, const char *name)
+	{
+		if (!equal)
+			names += string(names.empty() ? "" : ", ") + name;
+	};
+	check(same(a.gaussianRow, b.gaussianRow), "gaussianRow");
+	check(same(a.gaussianColumn, b.gaussianColumn), "gaussianColumn");
+	check(same(a.sobelG1, b.sobelG1) && same(a.sobelG2, b.sobelG2), "sobelRow");
+	check(same(a.amp, b.amp) && same(a.slope, b.slope), "sobelColumn");
+	check(same(a.gaussianRowInt, b.gaussianRowInt), "gaussianRowInt");
+	check(same(a.gaussianColumnInt, b.gaussianColumnInt), "gaussianColumnInt");
+	check(same(a.sobelG1Int, b.sobelG1Int) && same(a.sobelG2Int, b.sobelG2Int), "sobelRowInt");
+	check(same(a.ampInt, b.ampInt) && same(a.gxInt, b.gxInt) && same(a.gyInt, b.gyInt), "sobelColumnInt");
+	return names;
+}
+
+bool checkKernels(ostream &log)
+{
+	const FilterIsa supported = filterIsa();
+	const char *isaNames[] = { "scalar", "sse4.2", "avx2", "avx512" };
+	if (supported == ScalarIsa)
+	{
+		log << "kernels: the CPU has no vectorised kernels" << endl;
+		return true;
+	}
+
+	// every width up to a few vectors exercises the vector tails and the row borders
+	vector<int> widths;
+	for (int w = 1; w <= 100; w++)
+		widths.push_back(w);
+	widths.push_back(640);
+	widths.push_back(1923);
+
+	bool passed = true;
+	mt19937 random(1);
+	for (const int w : widths)
+	{
+		setFilterIsa(ScalarIsa);
+		const KernelInputs in(w, random);
+		KernelOutputs scalar(w);
+		runKernels(in, scalar, w);
+
+		for (int isa = Sse42Isa; isa <= supported; isa++)
+		{
+			setFilterIsa((FilterIsa)isa);
+			KernelOutputs vectorised(w);
+			runKernels(in, vectorised, w);
+			const string names = differences(scalar, vectorised);
+			if (!names.empty())
+			{
+				log << "kernels " << isaNames[isa] << " width " << w << ": " << names << " differ from scalar" << endl;
+				passed = false;
+			}
+		}
+	}
+	log << "kernels of " << isaNames[Sse42Isa] << " to " << isaNames[supported] << " compared with scalar at "
+		<< widths.size() << " widths" << endl;
+
+	// and so do the lines of the front ends built on the kernels
+	const vector<Image<unsigned char>> scenes = checkScenes(641, 479, 2);
+	const HoughTransform::FrontEnd frontEnds[] = { HoughTransform::FusedFilters, HoughTransform::IntegerFilters,
+		HoughTransform::StreamingFilters };
+	const char *frontEndNames[] = { "fused", "integer", "streaming" };
+	for (int f = 0; f < 3; f++)
+	{
+		HoughTransform H(641, 479);
+		H.setFrontEnd(frontEnds[f]);
+		for (const auto &scene : scenes)
+		{
+			setFilterIsa(ScalarIsa);
+			const vector<array<int, 4>> lines = H.process(scene.view(), 20, 5, 40);
+			const size_t edges = H.edgeCount();
+			for (int isa = Sse42Isa; isa <= supported; isa++)
+			{
+				setFilterIsa((FilterIsa)isa);
+				if (H.process(scene.view(), 20, 5, 40) != lines || H.edgeCount() != edges)
+				{
+					log << "kernels " << isaNames[isa] << ": lines of " << frontEndNames[f] << " differ from scalar" << endl;
+					passed = false;
+				}
+			}
+		}
+	}
+
+	setFilterIsa(supported);
+	return passed;
+}
@@ -0,0 +1,59 @@
+#include "Checks.h"
+
+#include <cstring>
+
+#include "HoughTransform.h"
+
+using namespace std;
+
+static bool sameVotes(const HoughAccumulator &A, const HoughAccumulator &B)
+{
+	for (int i = 0; i < A.rows(); i++)
+		if (memcmp(A.row(i), B.row(i), A.rowLength() * sizeof(int)) != 0)
+			return false;
+	return true;
+}
+
+bool checkParallelVoting(ostream &log)
+{
+	const vector<Image<unsigned char>> scenes = checkScenes(640, 480, 3);
+
+	// StreamingFilters always votes serially, so for it the check only shows that setNumThreads,
+	// which still runs the peak search on the pool, does not change its results
+	const HoughTransform::FrontEnd frontEnds[] = { HoughTransform::ReferenceFilters, HoughTransform::FusedFilters,
+		HoughTransform::IntegerFilters, HoughTransform::StreamingFilters };
+	const char *frontEndNames[] = { "reference", "fused", "integer", "streaming" };
+	const HoughTransform::VotingMode modes[] = { HoughTransform::FullVoting, HoughTransform::GradientVoting };
+	const char *modeNames[] = { "full", "gradient" };
+	const HoughAccumulator::Layout layouts[] = { HoughAccumulator::ThetaMajor, HoughAccumulator::RhoMajor };
+	const char *layoutNames[] = { "theta-major", "rho-major" };
+
+	// the votes of every thread are summed exactly, so the matrix and the lines do not
+	// depend on the number of threads
+	bool passed = true;
+	for (int f = 0; f < 4; f++)
+		for (int m = 0; m < 2; m++)
+			for (int l = 0; l < 2; l++)
+			{
+				HoughTransform serial(640, 480, 1.0, layouts[l]);
+				HoughTransform parallel(640, 480, 1.0, layouts[l]);
+				serial.setFrontEnd(frontEnds[f]);
+				parallel.setFrontEnd(frontEnds[f]);
+				parallel.setNumThreads(4);
+
+				int differences = 0;
+				for (const auto &scene : scenes)
+				{
+					const vector<array<int, 4>> &lines = serial.process(scene.view(), 20, 5, 40, modes[m]);
+					if (parallel.process(scene.view(), 20, 5, 40, modes[m]) != lines ||
+						!sameVotes(serial.votingMatrix(), parallel.votingMatrix()))
+						differences++;
+				}
+
+				log << "parallel voting " << frontEndNames[f] << " " << modeNames[m] << " " << layoutNames[l]
+					<< ": " << differences << " of " << scenes.size() << " scenes differ" << endl;
+				if (differences != 0)
+					passed = false;
+			}
+	return passed;
+}
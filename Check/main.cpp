@@ -0,0 +1,42 @@
+#include <iostream>
+
+#include "Checks.h"
+#include "SyntheticLines.h"
+
+using namespace std;
+
+// Check
+// runs every check and exits with 1 if one of them fails
+
+vector<Image<unsigned char>> checkScenes(const size_t w, const size_t h, const int count)
+{
+	// cluttered and noisy, so weak edges, hysteresis and many peaks are exercised
+	SceneParameters scene;
+	scene.numOfSegments = 20;
+	scene.minLength = 40;
+	scene.clutter = 50;
+	scene.noise = 6;
+	SyntheticLines generator(scene);
+
+	vector<Image<unsigned char>> scenes;
+	for (int i = 0; i < count; i++)
+		scenes.push_back(generator.render(w, h));
+	return scenes;
+}
+
+int main()
+{
+	struct NamedCheck { const char *name; bool(*run)(ostream &log); };
+	const NamedCheck checks[] = { { "allocations", checkAllocations }, { "parallel voting", checkParallelVoting },
+		{ "kernels", checkKernels }, { "bit images", checkBitImages } };
+
+	int failed = 0;
+	for (const auto &check : checks)
+	{
+		const bool passed = check.run(cerr);
+		cout << (passed ? "passed " : "FAILED ") << check.name << endl;
+		if (!passed)
+			failed++;
+	}
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+#ifndef _ALIGNED_H
+#define _ALIGNED_H
+
+#include <cstdlib>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+// cache line size, used as default alignment of working buffers
+const size_t CACHE_LINE = 64;
+
+// round n up to a multiple of m
+inline size_t roundUp(const size_t n, const size_t m)
+{
+	return (n + m - 1) / m * m;
+}
+
+// allocate bytes aligned to alignment (a power of two), free with alignedFree
+inline void *alignedAlloc(const size_t bytes, const size_t alignment = CACHE_LINE)
+{
+#ifdef _MSC_VER
+	return _aligned_malloc(bytes, alignment);
+#else
+	void *p = nullptr;
+	if (posix_memalign(&p, alignment, bytes) != 0)
+		return nullptr;
+	return p;
+#endif
+}
+
+inline void alignedFree(void *p)
+{
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+#endif
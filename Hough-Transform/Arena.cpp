@@ -0,0 +1,84 @@
+#include <new>
+
+#include "Arena.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define HOUGH_MMAP
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+// huge pages are only worth it for blocks of at least one huge page
+static const size_t HUGE_PAGE = 2 << 20;
+
+Arena::Arena(const size_t capacity) :
+	base(nullptr), size(capacity), mapped(roundUp(capacity > 0 ? capacity : 1, 4096)), top(0), huge(false)
+{
+#if defined(_WIN32)
+	// large pages need the lock memory privilege, fall back to normal pages without it
+	const size_t largePage = GetLargePageMinimum();
+	if (largePage > 0 && mapped >= largePage)
+	{
+		base = (char *)VirtualAlloc(nullptr, roundUp(mapped, largePage),
+			MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (base != nullptr)
+		{
+			mapped = roundUp(mapped, largePage);
+			huge = true;
+		}
+	}
+	if (base == nullptr)
+		base = (char *)VirtualAlloc(nullptr, mapped, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(HOUGH_MMAP)
+	// explicit huge pages only exist if the system reserved some, otherwise ask for
+	// transparent huge pages on normal pages
+	void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+	if (mapped >= HUGE_PAGE)
+	{
+		p = mmap(nullptr, roundUp(mapped, HUGE_PAGE), PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED)
+		{
+			mapped = roundUp(mapped, HUGE_PAGE);
+			huge = true;
+		}
+	}
+#endif
+	if (p == MAP_FAILED)
+		p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+#ifdef MADV_HUGEPAGE
+	if (p != MAP_FAILED && !huge && mapped >= HUGE_PAGE)
+		huge = madvise(p, mapped, MADV_HUGEPAGE) == 0;
+#endif
+	base = p == MAP_FAILED ? nullptr : (char *)p;
+#else
+	base = (char *)alignedAlloc(mapped, 4096);
+#endif
+	if (base == nullptr)
+		throw std::bad_alloc();
+}
+
+Arena::~Arena()
+{
+#if defined(_WIN32)
+	VirtualFree(base, 0, MEM_RELEASE);
+#elif defined(HOUGH_MMAP)
+	munmap(base, mapped);
+#else
+	alignedFree(base);
+#endif
+}
+
+void *Arena::allocate(const size_t bytes, const size_t alignment)
+{
+	const size_t start = roundUp(top, alignment);
+	const size_t end = start + roundUp(bytes, CACHE_LINE);
+	if (end > size)
+		throw std::bad_alloc();
+	top = end;
+	return base + start;
+}
@@ -0,0 +1,41 @@
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <cstddef>
+
+#include "Aligned.h"
+
+// one block of memory handing out aligned buffers by bumping a pointer. buffers are never
+// freed on their own, only all together with the arena. the block is mapped from the system,
+// so pages nobody touches cost no physical memory, and backed by huge pages where available.
+class Arena
+{
+public:
+	explicit Arena(const size_t capacity);
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+	~Arena();
+
+	// bytes rounded up to whole cache lines, so buffers never share a cache line.
+	// throws std::bad_alloc when the arena is full.
+	void *allocate(const size_t bytes, const size_t alignment = CACHE_LINE);
+
+	template <typename T>
+	T *alloc(const size_t n)
+	{
+		return (T *)allocate(n * sizeof(T));
+	}
+
+	size_t capacity() const { return size; }
+	size_t used() const { return top; }	// bytes handed out so far, the high-water mark
+	bool hugePages() const { return huge; }
+
+private:
+	char *base;
+	size_t size;
+	size_t mapped;	// bytes mapped from the system, size rounded up to whole pages
+	size_t top;		// offset of the first free byte
+	bool huge;
+};
+
+#endif
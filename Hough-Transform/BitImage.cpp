@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "Aligned.h"
+#include "BitImage.h"
+
+using namespace std;
+
+BitImage::BitImage(const size_t w, const size_t h, Arena *arena) :
+	width(w), height(h), wordsPerRow((w + 63) / 64), ownsWords(arena == nullptr)
+{
+	const size_t n = max(wordsPerRow*height, (size_t)1);
+	words = arena ? arena->alloc<uint64_t>(n) : (uint64_t *)alignedAlloc(n*sizeof(uint64_t));
+	if (words == nullptr)
+		throw std::bad_alloc();
+	clear();
+}
+
+BitImage::~BitImage()
+{
+	if (ownsWords)
+		alignedFree(words);
+}
+
+void BitImage::clear()
+{
+	memset(words, 0, wordsPerRow*height*sizeof(uint64_t));
+}
+
+void BitImage::clearRows(const size_t y0, const size_t y1)
+{
+	memset(row(y0), 0, (y1 - y0)*wordsPerRow*sizeof(uint64_t));
+}
+
+size_t BitImage::count() const
+{
+	size_t n = 0;
+	for (size_t i = 0; i < wordsPerRow*height; i++)
+		n += popcount64(words[i]);
+	return n;
+}
+
+BitImage& BitImage::operator&=(const BitImage &B)
+{
+	for (size_t i = 0; i < wordsPerRow*height; i++)
+		words[i] &= B.words[i];
+	return *this;
+}
+
+BitImage& BitImage::operator|=(const BitImage &B)
+{
+	for (size_t i = 0; i < wordsPerRow*height; i++)
+		words[i] |= B.words[i];
+	return *this;
+}
+
+void BitImage::dilate(const BitImage &B)
+{
+	// OR of the rows above, at and below, each shifted one pixel left and right.
+	// bits shifted across a word boundary are carried over from the neighbouring word.
+	const size_t n = wordsPerRow;
+	const uint64_t lastMask = width % 64 == 0 ? ~(uint64_t)0 : ((uint64_t)1 << (width % 64)) - 1;
+	for (size_t y = 0; y < height; y++)
+	{
+		uint64_t *dst = row(y);
+		for (size_t i = 0; i < n; i++)
+		{
+			uint64_t v = 0;
+			for (size_t k = (y > 0 ? y - 1 : 0); k <= y + 1 && k < height; k++)
+			{
+				const uint64_t *src = B.row(k);
+				v |= src[i] | src[i] << 1 | src[i] >> 1;
+				if (i > 0)
+					v |= src[i - 1] >> 63;
+				if (i + 1 < n)
+					v |= src[i + 1] << 63;
+			}
+			dst[i] = i + 1 < n ? v : v & lastMask;
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#ifndef _BITIMAGE_H
+#define _BITIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Arena.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// number of set bits
+inline int popcount64(const uint64_t v)
+{
+#ifdef _MSC_VER
+	return (int)__popcnt64(v);
+#else
+	return __builtin_popcountll(v);
+#endif
+}
+
+// index of the lowest set bit, v must not be zero
+inline int ctz64(const uint64_t v)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward64(&i, v);
+	return (int)i;
+#else
+	return __builtin_ctzll(v);
+#endif
+}
+
+// binary image with one bit per pixel. every row starts on a new 64-bit word, bit x % 64
+// of word x / 64 holds pixel x, and the padding bits after the last pixel of a row stay zero.
+// rows never share words, so bands of rows can be written by different threads.
+class BitImage
+{
+public:
+	// the words are taken from arena if given, otherwise owned by the image
+	BitImage(const size_t w, const size_t h, Arena *arena = nullptr);
+	BitImage(const BitImage&) = delete;
+	BitImage& operator=(const BitImage&) = delete;
+	~BitImage();
+
+	const size_t width;
+	const size_t height;
+	const size_t wordsPerRow;
+
+	uint64_t *row(const size_t y) { return words + y*wordsPerRow; }
+	const uint64_t *row(const size_t y) const { return words + y*wordsPerRow; }
+
+	bool test(const size_t x, const size_t y) const { return (row(y)[x >> 6] >> (x & 63)) & 1; }
+	void set(const size_t x, const size_t y) { row(y)[x >> 6] |= (uint64_t)1 << (x & 63); }
+
+	void clear();	// clear all pixels
+	void clearRows(const size_t y0, const size_t y1);	// clear rows y0 : y1 - 1
+	size_t count() const;	// number of set pixels
+
+	// pixel-wise operations with an image of equal size
+	BitImage& operator&=(const BitImage &B);
+	BitImage& operator|=(const BitImage &B);
+	void dilate(const BitImage &B);	// set to B dilated by the 3x3 square, B must be another image
+
+	// call f(x, y) for every set pixel of rows y0 : y1 - 1 in raster order, skipping empty words
+	template <typename F>
+	void forEach(const size_t y0, const size_t y1, F f) const
+	{
+		for (size_t y = y0; y < y1; y++)
+		{
+			const uint64_t *r = row(y);
+			for (size_t i = 0; i < wordsPerRow; i++)
+				for (uint64_t bits = r[i]; bits != 0; bits &= bits - 1)
+					f((int)(i * 64 + ctz64(bits)), (int)y);
+		}
+	}
+
+private:
+	uint64_t *words;
+	bool ownsWords;
+};
+
+#endif
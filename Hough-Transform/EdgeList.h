@@ -0,0 +1,45 @@
+#ifndef _EDGELIST_H
+#define _EDGELIST_H
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+// coordinates of the pixels of a binary edge image in raster order,
+// stored as separate x and y arrays so loops over them stay sequential
+struct EdgeList
+{
+	vector<int> x;
+	vector<int> y;
+
+	size_t size() const { return x.size(); }
+	bool empty() const { return x.empty(); }
+
+	// clear keeps the capacity, so a reused list stops allocating once it is large enough
+	void clear()
+	{
+		x.clear();
+		y.clear();
+	}
+
+	void reserve(const size_t n)
+	{
+		x.reserve(n);
+		y.reserve(n);
+	}
+
+	void resize(const size_t n)
+	{
+		x.resize(n);
+		y.resize(n);
+	}
+
+	void push_back(const int px, const int py)
+	{
+		x.push_back(px);
+		y.push_back(py);
+	}
+};
+
+#endif
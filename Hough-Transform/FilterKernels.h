@@ -0,0 +1,40 @@
+#ifndef _FILTERKERNELS_H
+#define _FILTERKERNELS_H
+
+// table of the row kernels of Filters.h, one per instruction set.
+// the vector instances are defined in FiltersSse42.cpp, FiltersAvx2.cpp and FiltersAvx512.cpp
+
+#include "Filters.h"
+
+struct FilterKernels
+{
+	void(*gaussianRow)(const unsigned char *src, float *dst, const int w);
+	void(*gaussianColumn)(const float *const rows[5], float *dst, const int w);
+	void(*sobelRow)(const float *src, float *g1, float *g2, const int w);
+	void(*sobelColumn)(const float *const g1[3], const float *const g2[3], float *amp, float *slope, const int w);
+
+	void(*gaussianRowInt)(const unsigned char *src, short *dst, const int w);
+	void(*gaussianColumnInt)(const short *const rows[5], short *dst, const int w);
+	void(*sobelRowInt)(const short *src, short *g1, short *g2, const int w);
+	void(*sobelColumnInt)(const short *const g1[3], const short *const g2[3], short *amp, short *gx, short *gy, const int w);
+};
+
+extern const FilterKernels scalarFilterKernels;
+#ifdef HOUGH_X86
+extern const FilterKernels sse42FilterKernels;
+extern const FilterKernels avx2FilterKernels;
+extern const FilterKernels avx512FilterKernels;
+#endif
+
+// scalar kernels restricted to the columns j0 : j1 - 1.
+// used by the vector kernels for the image borders and the columns left over
+void gaussianRowScalar(const unsigned char *src, float *dst, const int w, const int j0, const int j1);
+void gaussianColumnScalar(const float *const rows[5], float *dst, const int j0, const int j1);
+void sobelRowScalar(const float *src, float *g1, float *g2, const int w, const int j0, const int j1);
+void sobelColumnScalar(const float *const g1[3], const float *const g2[3], float *amp, float *slope, const int j0, const int j1);
+void gaussianRowIntScalar(const unsigned char *src, short *dst, const int w, const int j0, const int j1);
+void gaussianColumnIntScalar(const short *const rows[5], short *dst, const int j0, const int j1);
+void sobelRowIntScalar(const short *src, short *g1, short *g2, const int w, const int j0, const int j1);
+void sobelColumnIntScalar(const short *const g1[3], const short *const g2[3], short *amp, short *gx, short *gy, const int j0, const int j1);
+
+#endif
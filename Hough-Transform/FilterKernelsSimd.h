@@ -0,0 +1,154 @@
+#ifndef _FILTERKERNELSSIMD_H
+#define _FILTERKERNELSSIMD_H
+
+// vectorised row kernels, instantiated once per instruction set in the Filters*.cpp files.
+// include this header where the target instruction set is enabled so the templates are compiled for it.
+// vector lanes do the same multiplications and additions in the same order as the
+// scalar kernels, so all instruction sets give bit-identical results.
+
+#include "FilterKernels.h"
+
+// V wraps one vector register type: V::N float lanes, loads, stores and arithmetic
+template <class V>
+void gaussianRowSimd(const unsigned char *src, float *dst, const int w)
+{
+	const float *f = gaussianKernel;
+	const typename V::F f0 = V::set1(f[0]), f1 = V::set1(f[1]), f2 = V::set1(f[2]), f3 = V::set1(f[3]), f4 = V::set1(f[4]);
+
+	// interior, all taps inside the row
+	int j = 2;
+	for (; j + V::N <= w - 2; j += V::N)
+	{
+		typename V::F v = V::mul(f0, V::loadU8(src + j - 2));
+		v = V::add(v, V::mul(f1, V::loadU8(src + j - 1)));
+		v = V::add(v, V::mul(f2, V::loadU8(src + j)));
+		v = V::add(v, V::mul(f3, V::loadU8(src + j + 1)));
+		v = V::add(v, V::mul(f4, V::loadU8(src + j + 2)));
+		V::store(dst + j, v);
+	}
+	gaussianRowScalar(src, dst, w, 0, w < 2 ? w : 2);
+	gaussianRowScalar(src, dst, w, j, w);
+}
+
+template <class V>
+void gaussianColumnSimd(const float *const rows[5], float *dst, const int w)
+{
+	const float *f = gaussianKernel;
+	const typename V::F f0 = V::set1(f[0]), f1 = V::set1(f[1]), f2 = V::set1(f[2]), f3 = V::set1(f[3]), f4 = V::set1(f[4]);
+
+	int j = 0;
+	for (; j + V::N <= w; j += V::N)
+	{
+		typename V::F v = V::mul(f0, V::load(rows[0] + j));
+		v = V::add(v, V::mul(f1, V::load(rows[1] + j)));
+		v = V::add(v, V::mul(f2, V::load(rows[2] + j)));
+		v = V::add(v, V::mul(f3, V::load(rows[3] + j)));
+		v = V::add(v, V::mul(f4, V::load(rows[4] + j)));
+		V::store(dst + j, v);
+	}
+	gaussianColumnScalar(rows, dst, j, w);
+}
+
+template <class V>
+void sobelRowSimd(const float *src, float *g1, float *g2, const int w)
+{
+	const typename V::F two = V::set1(2.0f);
+
+	// interior, both neighbours inside the row
+	int j = 1;
+	for (; j + V::N <= w - 1; j += V::N)
+	{
+		const typename V::F left = V::load(src + j - 1);
+		const typename V::F right = V::load(src + j + 1);
+		V::store(g1 + j, V::sub(left, right));
+		V::store(g2 + j, V::add(V::add(left, V::mul(two, V::load(src + j))), right));
+	}
+	sobelRowScalar(src, g1, g2, w, 0, w < 1 ? w : 1);
+	sobelRowScalar(src, g1, g2, w, j, w);
+}
+
+template <class V>
+void sobelColumnSimd(const float *const g1[3], const float *const g2[3], float *amp, float *slope, const int w)
+{
+	const typename V::F two = V::set1(2.0f);
+
+	int j = 0;
+	for (; j + V::N <= w; j += V::N)
+	{
+		const typename V::F Gx = V::add(V::add(V::load(g1[0] + j), V::mul(two, V::load(g1[1] + j))), V::load(g1[2] + j));
+		const typename V::F Gy = V::sub(V::load(g2[0] + j), V::load(g2[2] + j));
+		V::store(amp + j, V::add(V::abs(Gx), V::abs(Gy)));
+		V::store(slope + j, V::div(Gy, Gx));
+	}
+	sobelColumnScalar(g1, g2, amp, slope, j, w);
+}
+
+// I wraps one integer vector register type: I::N lanes of 16 bits.
+// values of the Gaussian stay below 2^16 and are shifted logically, so they can be
+// held in signed lanes; the Sobel parts fit in signed 16 bits.
+template <class I>
+void gaussianRowIntSimd(const unsigned char *src, short *dst, const int w)
+{
+	int j = 2;
+	for (; j + I::N <= w - 2; j += I::N)
+	{
+		const typename I::V c = I::loadU8(src + j);
+		typename I::V v = I::add(I::loadU8(src + j - 2), I::loadU8(src + j + 2));
+		v = I::add(v, I::shl2(I::add(I::loadU8(src + j - 1), I::loadU8(src + j + 1))));
+		v = I::add(v, I::add(I::shl2(c), I::add(c, c)));
+		I::store(dst + j, v);
+	}
+	gaussianRowIntScalar(src, dst, w, 0, w < 2 ? w : 2);
+	gaussianRowIntScalar(src, dst, w, j, w);
+}
+
+template <class I>
+void gaussianColumnIntSimd(const short *const rows[5], short *dst, const int w)
+{
+	const typename I::V half = I::set1(8);
+
+	int j = 0;
+	for (; j + I::N <= w; j += I::N)
+	{
+		const typename I::V c = I::load(rows[2] + j);
+		typename I::V v = I::add(I::load(rows[0] + j), I::load(rows[4] + j));
+		v = I::add(v, I::shl2(I::add(I::load(rows[1] + j), I::load(rows[3] + j))));
+		v = I::add(v, I::add(I::shl2(c), I::add(c, c)));
+		I::store(dst + j, I::shr4(I::add(v, half)));
+	}
+	gaussianColumnIntScalar(rows, dst, j, w);
+}
+
+template <class I>
+void sobelRowIntSimd(const short *src, short *g1, short *g2, const int w)
+{
+	int j = 1;
+	for (; j + I::N <= w - 1; j += I::N)
+	{
+		const typename I::V left = I::load(src + j - 1);
+		const typename I::V right = I::load(src + j + 1);
+		const typename I::V c = I::load(src + j);
+		I::store(g1 + j, I::sub(left, right));
+		I::store(g2 + j, I::add(I::add(left, I::add(c, c)), right));
+	}
+	sobelRowIntScalar(src, g1, g2, w, 0, w < 1 ? w : 1);
+	sobelRowIntScalar(src, g1, g2, w, j, w);
+}
+
+template <class I>
+void sobelColumnIntSimd(const short *const g1[3], const short *const g2[3], short *amp, short *gx, short *gy, const int w)
+{
+	int j = 0;
+	for (; j + I::N <= w; j += I::N)
+	{
+		const typename I::V c = I::load(g1[1] + j);
+		const typename I::V Gx = I::add(I::add(I::load(g1[0] + j), I::add(c, c)), I::load(g1[2] + j));
+		const typename I::V Gy = I::sub(I::load(g2[0] + j), I::load(g2[2] + j));
+		I::store(amp + j, I::add(I::abs(Gx), I::abs(Gy)));
+		I::store(gx + j, Gx);
+		I::store(gy + j, Gy);
+	}
+	sobelColumnIntScalar(g1, g2, amp, gx, gy, j, w);
+}
+
+#endif
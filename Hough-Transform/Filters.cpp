@@ -0,0 +1,268 @@
+#include <cmath>
+#include <cstdlib>
+
+#include "FilterKernels.h"
+
+#ifdef HOUGH_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+const float gaussianKernel[5] = { 0.0545f, 0.2442f, 0.4026f, 0.2442f, 0.0545f };
+
+void gaussianRowScalar(const unsigned char *src, float *dst, const int w, const int j0, const int j1)
+{
+	const float *f = gaussianKernel;
+	for (int j = j0; j < j1; j++)
+	{
+		if (j >= 2 && j < w - 2)
+		{
+			dst[j] = f[0] * src[j - 2] + f[1] * src[j - 1] + f[2] * src[j] + f[3] * src[j + 1] + f[4] * src[j + 2];
+			continue;
+		}
+
+		// borders, skipping taps outside the row
+		float value = 0;
+		for (int k = -2; k <= 2; k++)
+			if (j + k >= 0 && j + k < w)
+				value += f[k + 2] * src[j + k];
+		dst[j] = value;
+	}
+}
+
+void gaussianColumnScalar(const float *const rows[5], float *dst, const int j0, const int j1)
+{
+	const float *f = gaussianKernel;
+	for (int j = j0; j < j1; j++)
+		dst[j] = f[0] * rows[0][j] + f[1] * rows[1][j] + f[2] * rows[2][j] + f[3] * rows[3][j] + f[4] * rows[4][j];
+}
+
+void sobelRowScalar(const float *src, float *g1, float *g2, const int w, const int j0, const int j1)
+{
+	for (int j = j0; j < j1; j++)
+	{
+		const float left = j > 0 ? src[j - 1] : 0;
+		const float right = j < w - 1 ? src[j + 1] : 0;
+		g1[j] = left - right;
+		g2[j] = left + 2 * src[j] + right;
+	}
+}
+
+void sobelColumnScalar(const float *const g1[3], const float *const g2[3], float *amp, float *slope, const int j0, const int j1)
+{
+	float Gx, Gy;
+	for (int j = j0; j < j1; j++)
+	{
+		Gx = g1[0][j] + 2 * g1[1][j] + g1[2][j];
+		Gy = g2[0][j] - g2[2][j];
+		amp[j] = std::abs(Gx) + std::abs(Gy);
+		slope[j] = Gy / Gx;
+	}
+}
+
+void gaussianRowIntScalar(const unsigned char *src, short *dst, const int w, const int j0, const int j1)
+{
+	// binomial taps [1 4 6 4 1], pixels outside the row count as zero
+	for (int j = j0; j < j1; j++)
+	{
+		const int p0 = j >= 2 ? src[j - 2] : 0;
+		const int p1 = j >= 1 ? src[j - 1] : 0;
+		const int p3 = j < w - 1 ? src[j + 1] : 0;
+		const int p4 = j < w - 2 ? src[j + 2] : 0;
+		dst[j] = (short)(p0 + 4 * p1 + 6 * src[j] + 4 * p3 + p4);
+	}
+}
+
+void gaussianColumnIntScalar(const short *const rows[5], short *dst, const int j0, const int j1)
+{
+	// the sum has 8 fractional bits, keep 4 of them with rounding
+	for (int j = j0; j < j1; j++)
+		dst[j] = (short)((rows[0][j] + 4 * rows[1][j] + 6 * rows[2][j] + 4 * rows[3][j] + rows[4][j] + 8) >> 4);
+}
+
+void sobelRowIntScalar(const short *src, short *g1, short *g2, const int w, const int j0, const int j1)
+{
+	for (int j = j0; j < j1; j++)
+	{
+		const int left = j > 0 ? src[j - 1] : 0;
+		const int right = j < w - 1 ? src[j + 1] : 0;
+		g1[j] = (short)(left - right);
+		g2[j] = (short)(left + 2 * src[j] + right);
+	}
+}
+
+void sobelColumnIntScalar(const short *const g1[3], const short *const g2[3], short *amp, short *gx, short *gy, const int j0, const int j1)
+{
+	int Gx, Gy;
+	for (int j = j0; j < j1; j++)
+	{
+		Gx = g1[0][j] + 2 * g1[1][j] + g1[2][j];
+		Gy = g2[0][j] - g2[2][j];
+		amp[j] = (short)(abs(Gx) + abs(Gy));
+		gx[j] = (short)Gx;
+		gy[j] = (short)Gy;
+	}
+}
+
+static void gaussianRowAll(const unsigned char *src, float *dst, const int w)
+{
+	gaussianRowScalar(src, dst, w, 0, w);
+}
+
+static void gaussianColumnAll(const float *const rows[5], float *dst, const int w)
+{
+	gaussianColumnScalar(rows, dst, 0, w);
+}
+
+static void sobelRowAll(const float *src, float *g1, float *g2, const int w)
+{
+	sobelRowScalar(src, g1, g2, w, 0, w);
+}
+
+static void sobelColumnAll(const float *const g1[3], const float *const g2[3], float *amp, float *slope, const int w)
+{
+	sobelColumnScalar(g1, g2, amp, slope, 0, w);
+}
+
+static void gaussianRowIntAll(const unsigned char *src, short *dst, const int w)
+{
+	gaussianRowIntScalar(src, dst, w, 0, w);
+}
+
+static void gaussianColumnIntAll(const short *const rows[5], short *dst, const int w)
+{
+	gaussianColumnIntScalar(rows, dst, 0, w);
+}
+
+static void sobelRowIntAll(const short *src, short *g1, short *g2, const int w)
+{
+	sobelRowIntScalar(src, g1, g2, w, 0, w);
+}
+
+static void sobelColumnIntAll(const short *const g1[3], const short *const g2[3], short *amp, short *gx, short *gy, const int w)
+{
+	sobelColumnIntScalar(g1, g2, amp, gx, gy, 0, w);
+}
+
+const FilterKernels scalarFilterKernels = {
+	gaussianRowAll, gaussianColumnAll, sobelRowAll, sobelColumnAll,
+	gaussianRowIntAll, gaussianColumnIntAll, sobelRowIntAll, sobelColumnIntAll
+};
+
+static FilterIsa detectIsa()
+{
+#ifdef HOUGH_X86
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+	__cpuid(info, 1);
+	const bool sse42 = (info[2] & (1 << 20)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool avx2 = false;
+	bool avx512 = false;
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		// the OS has to save the ymm (and for AVX-512 the zmm) registers
+		avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+		avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6;
+	}
+	if (avx512)
+		return Avx512Isa;
+	if (avx2)
+		return Avx2Isa;
+	if (sse42)
+		return Sse42Isa;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return Avx512Isa;
+	if (__builtin_cpu_supports("avx2"))
+		return Avx2Isa;
+	if (__builtin_cpu_supports("sse4.2"))
+		return Sse42Isa;
+#endif
+#endif
+	return ScalarIsa;
+}
+
+static const FilterKernels *kernelsOf(const FilterIsa isa)
+{
+	switch (isa)
+	{
+#ifdef HOUGH_X86
+	case Sse42Isa:
+		return &sse42FilterKernels;
+	case Avx2Isa:
+		return &avx2FilterKernels;
+	case Avx512Isa:
+		return &avx512FilterKernels;
+#endif
+	default:
+		return &scalarFilterKernels;
+	}
+}
+
+static const FilterIsa supportedIsa = detectIsa();
+static FilterIsa currentIsa = supportedIsa;
+static const FilterKernels *kernels = kernelsOf(supportedIsa);
+// AVX-512F has no 16-bit integer instructions
+static const FilterKernels *intKernels = kernelsOf(supportedIsa == Avx512Isa ? Avx2Isa : supportedIsa);
+
+FilterIsa filterIsa()
+{
+	return currentIsa;
+}
+
+bool setFilterIsa(const FilterIsa isa)
+{
+	if (isa > supportedIsa)
+		return false;
+	currentIsa = isa;
+	kernels = kernelsOf(isa);
+	intKernels = kernelsOf(isa == Avx512Isa ? Avx2Isa : isa);
+	return true;
+}
+
+void gaussianRow(const unsigned char *src, float *dst, const int w)
+{
+	kernels->gaussianRow(src, dst, w);
+}
+
+void gaussianColumn(const float *const rows[5], float *dst, const int w)
+{
+	kernels->gaussianColumn(rows, dst, w);
+}
+
+void sobelRow(const float *src, float *g1, float *g2, const int w)
+{
+	kernels->sobelRow(src, g1, g2, w);
+}
+
+void sobelColumn(const float *const g1[3], const float *const g2[3], float *amp, float *slope, const int w)
+{
+	kernels->sobelColumn(g1, g2, amp, slope, w);
+}
+
+void gaussianRowInt(const unsigned char *src, short *dst, const int w)
+{
+	intKernels->gaussianRowInt(src, dst, w);
+}
+
+void gaussianColumnInt(const short *const rows[5], short *dst, const int w)
+{
+	intKernels->gaussianColumnInt(rows, dst, w);
+}
+
+void sobelRowInt(const short *src, short *g1, short *g2, const int w)
+{
+	intKernels->sobelRowInt(src, g1, g2, w);
+}
+
+void sobelColumnInt(const short *const g1[3], const short *const g2[3], short *amp, short *gx, short *gy, const int w)
+{
+	intKernels->sobelColumnInt(g1, g2, amp, gx, gy, w);
+}
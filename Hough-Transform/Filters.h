@@ -0,0 +1,49 @@
+#ifndef _FILTERS_H
+#define _FILTERS_H
+
+// row kernels of the edge detection front end. every kernel processes one image row
+// of w pixels, so a whole image can be filtered with a few rows of working memory.
+// pixels outside the image count as zero; rows outside the image are passed as a row of zeros.
+// the arithmetic matches GaussianFilter() and SobelEdge() operation by operation,
+// so the results are identical to the full-image filters.
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HOUGH_X86
+#endif
+
+// the kernels are vectorised for SSE4.2, AVX2 and AVX-512 and the best instruction set
+// supported by the CPU is selected at startup. every instruction set gives bit-identical results.
+enum FilterIsa { ScalarIsa, Sse42Isa, Avx2Isa, Avx512Isa };
+
+FilterIsa filterIsa();	// instruction set in use
+
+// use a lower instruction set, e.g. to compare against the scalar kernels.
+// returns false if the CPU does not support isa.
+bool setFilterIsa(const FilterIsa isa);
+
+extern const float gaussianKernel[5]; // Gaussian filter, width=5, sigma=1
+
+// horizontal Gaussian of one image row
+void gaussianRow(const unsigned char *src, float *dst, const int w);
+
+// vertical Gaussian, rows[k] is the horizontally filtered row y - 2 + k
+void gaussianColumn(const float *const rows[5], float *dst, const int w);
+
+// horizontal parts of the Sobel operator, g1 = [1 0 -1] and g2 = [1 2 1]
+void sobelRow(const float *src, float *g1, float *g2, const int w);
+
+// vertical parts of the Sobel operator, g1[k] and g2[k] belong to row y - 1 + k.
+// Gx = [1 2 1]' * g1 and Gy = [1 0 -1]' * g2 are combined into the
+// edge amplitude |Gx| + |Gy| and the slope Gy / Gx of the gradient
+void sobelColumn(const float *const g1[3], const float *const g2[3], float *amp, float *slope, const int w);
+
+// fixed-point versions of the kernels above for the integer front end. the Gaussian uses
+// the binomial taps [1 4 6 4 1] / 16 and the filtered image keeps 4 fractional bits, so
+// every intermediate and the amplitude fit in 16 bits. amplitudes are 16 times as large as
+// those of the float kernels. AVX-512F has no 16-bit instructions, so AVX2 is used instead.
+void gaussianRowInt(const unsigned char *src, short *dst, const int w);
+void gaussianColumnInt(const short *const rows[5], short *dst, const int w);
+void sobelRowInt(const short *src, short *g1, short *g2, const int w);
+void sobelColumnInt(const short *const g1[3], const short *const g2[3], short *amp, short *gx, short *gy, const int w);
+
+#endif
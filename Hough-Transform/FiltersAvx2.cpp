@@ -0,0 +1,75 @@
+// AVX2 instances of the filter kernels, only called on CPUs supporting them
+#include <cstring>
+
+#include "FilterKernels.h"
+
+#ifdef HOUGH_X86
+
+#include <immintrin.h>
+
+// compile the kernels below for AVX2 without making it a requirement of the whole program.
+// floating point contraction is disabled so the results stay identical to the scalar kernels
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "FilterKernelsSimd.h"
+
+struct Avx2Vector
+{
+	typedef __m256 F;
+	static const int N = 8;
+
+	static F set1(const float x) { return _mm256_set1_ps(x); }
+	static F load(const float *p) { return _mm256_loadu_ps(p); }
+	static F loadU8(const unsigned char *p)
+	{
+		return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)p)));
+	}
+	static void store(float *p, const F x) { _mm256_storeu_ps(p, x); }
+	static F add(const F a, const F b) { return _mm256_add_ps(a, b); }
+	static F sub(const F a, const F b) { return _mm256_sub_ps(a, b); }
+	static F mul(const F a, const F b) { return _mm256_mul_ps(a, b); }
+	static F div(const F a, const F b) { return _mm256_div_ps(a, b); }
+	static F abs(const F a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+};
+
+struct Avx2Int16
+{
+	typedef __m256i V;
+	static const int N = 16;
+
+	static V set1(const short x) { return _mm256_set1_epi16(x); }
+	static V load(const short *p) { return _mm256_loadu_si256((const __m256i *)p); }
+	static V loadU8(const unsigned char *p) { return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p)); }
+	static void store(short *p, const V x) { _mm256_storeu_si256((__m256i *)p, x); }
+	static V add(const V a, const V b) { return _mm256_add_epi16(a, b); }
+	static V sub(const V a, const V b) { return _mm256_sub_epi16(a, b); }
+	static V shl2(const V a) { return _mm256_slli_epi16(a, 2); }
+	static V shr4(const V a) { return _mm256_srli_epi16(a, 4); }
+	static V abs(const V a) { return _mm256_abs_epi16(a); }
+};
+
+const FilterKernels avx2FilterKernels = {
+	gaussianRowSimd<Avx2Vector>,
+	gaussianColumnSimd<Avx2Vector>,
+	sobelRowSimd<Avx2Vector>,
+	sobelColumnSimd<Avx2Vector>,
+	gaussianRowIntSimd<Avx2Int16>,
+	gaussianColumnIntSimd<Avx2Int16>,
+	sobelRowIntSimd<Avx2Int16>,
+	sobelColumnIntSimd<Avx2Int16>
+};
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
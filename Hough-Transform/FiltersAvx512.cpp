@@ -0,0 +1,60 @@
+// AVX-512 instances of the filter kernels, only called on CPUs supporting them
+#include <cstring>
+
+#include "FilterKernels.h"
+
+#ifdef HOUGH_X86
+
+#include <immintrin.h>
+
+// compile the kernels below for AVX-512 without making it a requirement of the whole program.
+// floating point contraction is disabled so the results stay identical to the scalar kernels
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "FilterKernelsSimd.h"
+
+struct Avx512Vector
+{
+	typedef __m512 F;
+	static const int N = 16;
+
+	static F set1(const float x) { return _mm512_set1_ps(x); }
+	static F load(const float *p) { return _mm512_loadu_ps(p); }
+	static F loadU8(const unsigned char *p)
+	{
+		// the zero-masking forms with all lanes selected are the same instructions, but GCC's
+		// unmasked ones merge into an undefined register and warn -Wmaybe-uninitialized
+		const __m512i x = _mm512_maskz_cvtepu8_epi32(0xffff, _mm_loadu_si128((const __m128i *)p));
+		return _mm512_maskz_cvtepi32_ps(0xffff, x);
+	}
+	static void store(float *p, const F x) { _mm512_storeu_ps(p, x); }
+	static F add(const F a, const F b) { return _mm512_add_ps(a, b); }
+	static F sub(const F a, const F b) { return _mm512_sub_ps(a, b); }
+	static F mul(const F a, const F b) { return _mm512_mul_ps(a, b); }
+	static F div(const F a, const F b) { return _mm512_div_ps(a, b); }
+	static F abs(const F a) { return _mm512_abs_ps(a); }
+};
+
+const FilterKernels avx512FilterKernels = {
+	gaussianRowSimd<Avx512Vector>,
+	gaussianColumnSimd<Avx512Vector>,
+	sobelRowSimd<Avx512Vector>,
+	sobelColumnSimd<Avx512Vector>,
+	// no 16-bit integer instructions in AVX-512F, the AVX2 kernels are used instead
+	nullptr, nullptr, nullptr, nullptr
+};
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+// SSE4.2 instances of the filter kernels, only called on CPUs supporting them
+#include <cstring>
+
+#include "FilterKernels.h"
+
+#ifdef HOUGH_X86
+
+#include <immintrin.h>
+
+// compile the kernels below for SSE4.2 without making it a requirement of the whole program.
+// floating point contraction is disabled so the results stay identical to the scalar kernels
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.2"))), apply_to = function)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.2")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "FilterKernelsSimd.h"
+
+struct Sse42Vector
+{
+	typedef __m128 F;
+	static const int N = 4;
+
+	static F set1(const float x) { return _mm_set1_ps(x); }
+	static F load(const float *p) { return _mm_loadu_ps(p); }
+	static F loadU8(const unsigned char *p)
+	{
+		int bytes;
+		memcpy(&bytes, p, sizeof(bytes));
+		return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes)));
+	}
+	static void store(float *p, const F x) { _mm_storeu_ps(p, x); }
+	static F add(const F a, const F b) { return _mm_add_ps(a, b); }
+	static F sub(const F a, const F b) { return _mm_sub_ps(a, b); }
+	static F mul(const F a, const F b) { return _mm_mul_ps(a, b); }
+	static F div(const F a, const F b) { return _mm_div_ps(a, b); }
+	static F abs(const F a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+};
+
+struct Sse42Int16
+{
+	typedef __m128i V;
+	static const int N = 8;
+
+	static V set1(const short x) { return _mm_set1_epi16(x); }
+	static V load(const short *p) { return _mm_loadu_si128((const __m128i *)p); }
+	static V loadU8(const unsigned char *p) { return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)p)); }
+	static void store(short *p, const V x) { _mm_storeu_si128((__m128i *)p, x); }
+	static V add(const V a, const V b) { return _mm_add_epi16(a, b); }
+	static V sub(const V a, const V b) { return _mm_sub_epi16(a, b); }
+	static V shl2(const V a) { return _mm_slli_epi16(a, 2); }
+	static V shr4(const V a) { return _mm_srli_epi16(a, 4); }
+	static V abs(const V a) { return _mm_abs_epi16(a); }
+};
+
+const FilterKernels sse42FilterKernels = {
+	gaussianRowSimd<Sse42Vector>,
+	gaussianColumnSimd<Sse42Vector>,
+	sobelRowSimd<Sse42Vector>,
+	sobelColumnSimd<Sse42Vector>,
+	gaussianRowIntSimd<Sse42Int16>,
+	gaussianColumnIntSimd<Sse42Int16>,
+	sobelRowIntSimd<Sse42Int16>,
+	sobelColumnIntSimd<Sse42Int16>
+};
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
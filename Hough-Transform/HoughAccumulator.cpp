@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "Aligned.h"
+#include "HoughAccumulator.h"
+#include "WorkerPool.h"
+
+using namespace std;
+
+HoughAccumulator::HoughAccumulator(const int numOfThetas, const int numOfRhos, const Layout layout) :
+	nTheta(numOfThetas), nRho(numOfRhos), layout(layout)
+{
+	// pad rows to a whole number of cache lines so SIMD loads never straddle two rows
+	rowStride = roundUp(rowLength(), CACHE_LINE / sizeof(int));
+	aStride = layout == ThetaMajor ? rowStride : 1;
+	rStride = layout == ThetaMajor ? 1 : rowStride;
+
+	cells = (int *)alignedAlloc(rows()*rowStride*sizeof(int));
+	if (cells == nullptr)
+		throw std::bad_alloc();
+	clear();
+}
+
+HoughAccumulator::~HoughAccumulator()
+{
+	alignedFree(cells);
+}
+
+void HoughAccumulator::clear()
+{
+	memset(cells, 0, rows()*rowStride*sizeof(int));
+}
+
+void HoughAccumulator::add(const HoughAccumulator &M, const int row0, const int row1)
+{
+	for (int i = row0; i < row1; i++)
+	{
+		int *dst = row(i);
+		const int *src = M.row(i);
+		for (int j = 0; j < rowLength(); j++)
+			dst[j] += src[j];
+	}
+}
+
+int HoughAccumulator::max() const
+{
+	int max = 0;
+	for (int i = 0; i < rows(); i++)
+	{
+		const int *p = row(i);
+		for (int j = 0; j < rowLength(); j++)
+			max = p[j] > max ? p[j] : max;
+	}
+	return max;
+}
+
+// strict weak order of peaks, strongest first, ties broken by the smallest (a, r)
+static bool stronger(const HoughPeak &p, const HoughPeak &q)
+{
+	if (p.value != q.value)
+		return p.value > q.value;
+	if (p.a != q.a)
+		return p.a < q.a;
+	return p.r < q.r;
+}
+
+bool HoughAccumulator::isLocalMax(const int a, const int r, const int value) const
+{
+	if (a > 0 && a < nTheta - 1 && r > 0 && r < nRho - 1)
+	{
+		const int *p = cells + a*aStride + r*rStride;
+		for (int da = -1; da <= 1; da++)
+			for (int dr = -1; dr <= 1; dr++)
+				if (p[da*(ptrdiff_t)aStride + dr*(ptrdiff_t)rStride] > value)
+					return false;
+		return true;
+	}
+
+	// borders: wrap around the theta axis with r mirrored, ignore r out of bounds
+	for (int da = -1; da <= 1; da++)
+		for (int dr = -1; dr <= 1; dr++)
+		{
+			int aTmp = a + da;
+			int rTmp = r + dr;
+			if (aTmp < 0 || aTmp >= nTheta)
+			{
+				aTmp = aTmp < 0 ? aTmp + nTheta : aTmp - nTheta;
+				rTmp = nRho - 1 - rTmp;
+			}
+			if (rTmp >= 0 && rTmp < nRho && at(aTmp, rTmp) > value)
+				return false;
+		}
+	return true;
+}
+
+void HoughAccumulator::collectPeaks(const int row0, const int row1, const size_t capacity,
+	vector<HoughPeak> &heap, int &max) const
+{
+	// the heap is ordered so that its front is the weakest peak kept
+	heap.clear();
+	max = 0;
+	for (int i = row0; i < row1; i++)
+	{
+		const int *p = row(i);
+		for (int j = 0; j < rowLength(); j++)
+		{
+			const int value = p[j];
+			if (value > max)
+				max = value;
+
+			// bins below half of the running maximum can never pass the final threshold
+			if (value == 0 || value <= max / 2)
+				continue;
+
+			const HoughPeak peak = layout == ThetaMajor ? HoughPeak{ value, i, j } : HoughPeak{ value, j, i };
+			if (heap.size() == capacity && !stronger(peak, heap.front()))
+				continue;
+			if (!isLocalMax(peak.a, peak.r, value))
+				continue;
+
+			if (heap.size() == capacity)
+			{
+				pop_heap(heap.begin(), heap.end(), stronger);
+				heap.back() = peak;
+			}
+			else
+				heap.push_back(peak);
+			push_heap(heap.begin(), heap.end(), stronger);
+		}
+	}
+}
+
+void HoughAccumulator::findPeaks(const int numOfPeaks, const int hooda, const int hoodr, vector<HoughPeak> &peaks,
+	WorkerPool *pool) const
+{
+	peaks.clear();
+	if (numOfPeaks <= 0)
+		return;
+
+	// every accepted peak suppresses at most one neighbourhood of bins, so the strongest
+	// numOfPeaks * (neighbourhood + 1) local maxima always contain the peaks found below
+	const size_t capacity = numOfPeaks * ((2 * hooda + 1) * (2 * hoodr + 1) + 1);
+
+	const int tasks = pool ? pool->size() : 1;
+	if (heaps.size() < (size_t)tasks)
+	{
+		heaps.resize(tasks);
+		maxima.resize(tasks);
+	}
+	auto collect = [&](const int i)
+	{
+		collectPeaks(rows() * i / tasks, rows() * (i + 1) / tasks, capacity, heaps[i], maxima[i]);
+	};
+	if (pool)
+		pool->parallelFor(tasks, collect);
+	else
+		collect(0);
+
+	candidates.clear();
+	int max = 0;
+	for (int i = 0; i < tasks; i++)
+	{
+		candidates.insert(candidates.end(), heaps[i].begin(), heaps[i].end());
+		max = maxima[i] > max ? maxima[i] : max;
+	}
+	sort(candidates.begin(), candidates.end(), stronger);
+
+	const int threshold = max / 2;
+	for (const auto &c : candidates)
+	{
+		if (c.value <= threshold || (int)peaks.size() == numOfPeaks)
+			break;
+
+		// skip candidates inside the neighbourhood of a stronger peak. a candidate
+		// past +/- 90 degrees of the peak shows up mirrored at the other end of theta.
+		bool suppressed = false;
+		for (const auto &p : peaks)
+		{
+			const int images[3][2] = { { c.a, c.r }, { c.a - nTheta, nRho - 1 - c.r }, { c.a + nTheta, nRho - 1 - c.r } };
+			for (const auto &q : images)
+				if (abs(q[0] - p.a) <= hooda && abs(q[1] - p.r) <= hoodr)
+					suppressed = true;
+		}
+		if (!suppressed)
+			peaks.push_back(c);
+	}
+}
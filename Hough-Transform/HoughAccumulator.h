@@ -0,0 +1,84 @@
+#ifndef _HOUGHACCUMULATOR_H
+#define _HOUGHACCUMULATOR_H
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+class WorkerPool;
+
+// a local maximum of the voting matrix
+struct HoughPeak
+{
+	int value;	// number of votes
+	int a;		// theta bin
+	int r;		// rho bin
+};
+
+// r-theta voting matrix of the Hough transform stored as one contiguous,
+// 64-byte aligned block. rows are padded so every row starts on a cache line.
+// ThetaMajor stores one row per theta bin, RhoMajor one row per rho bin.
+class HoughAccumulator
+{
+public:
+	enum Layout { ThetaMajor, RhoMajor };
+
+	HoughAccumulator(const int numOfThetas, const int numOfRhos, const Layout layout = ThetaMajor);
+	HoughAccumulator(const HoughAccumulator&) = delete;
+	HoughAccumulator& operator=(const HoughAccumulator&) = delete;
+	~HoughAccumulator();
+
+	const int nTheta;		// number of theta bins
+	const int nRho;			// number of rho bins
+	const Layout layout;
+
+	int rows() const { return layout == ThetaMajor ? nTheta : nRho; }
+	int rowLength() const { return layout == ThetaMajor ? nRho : nTheta; }
+	size_t stride() const { return rowStride; }	// elements between two rows
+
+	// distance in elements between neighbouring theta / rho bins
+	size_t thetaStride() const { return aStride; }
+	size_t rhoStride() const { return rStride; }
+
+	int *data() { return cells; }
+	const int *data() const { return cells; }
+	int *row(const int i) { return cells + i*rowStride; }
+	const int *row(const int i) const { return cells + i*rowStride; }
+
+	int &at(const int a, const int r) { return cells[a*aStride + r*rStride]; }
+	int at(const int a, const int r) const { return cells[a*aStride + r*rStride]; }
+
+	void clear();	// set all bins to zero
+	void add(const HoughAccumulator &M, const int row0, const int row1);	// add rows row0 : row1 - 1 of M, of equal shape
+	int max() const;
+
+	// find up to numOfPeaks peaks in one pass over the matrix, strongest first.
+	// a peak is a local maximum with more than half the votes of the global maximum.
+	// accepted peaks suppress the (hooda*2+1)x(hoodr*2+1) neighbourhood around them.
+	// the matrix is antisymmetric along the rho axis for theta = +/- 90 degrees,
+	// so neighbourhoods wrap around the theta axis with r mirrored.
+	// the matrix is not modified. rows are searched in parallel if pool is given.
+	void findPeaks(const int numOfPeaks, const int hooda, const int hoodr, vector<HoughPeak> &peaks,
+		WorkerPool *pool = nullptr) const;
+
+private:
+	bool isLocalMax(const int a, const int r, const int value) const;
+
+	// push the local maxima of rows row0 : row1 - 1 into a heap of the best capacity ones,
+	// max receives the largest bin of those rows
+	void collectPeaks(const int row0, const int row1, const size_t capacity,
+		vector<HoughPeak> &heap, int &max) const;
+
+	// scratch of findPeaks, kept so repeated searches do not allocate
+	mutable vector<vector<HoughPeak>> heaps;
+	mutable vector<int> maxima;
+	mutable vector<HoughPeak> candidates;
+
+	size_t rowStride;
+	size_t aStride;
+	size_t rStride;
+	int *cells;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include "HoughBatch.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+HoughBatch::HoughBatch(int numOfThreads, const HoughParameters &parameters) :
+	parameters(parameters), images(nullptr), running(0), generation(0), stop(false)
+{
+	// numOfThreads = 0 uses one thread per hardware thread
+	if (numOfThreads <= 0)
+		numOfThreads = max(1, (int)std::thread::hardware_concurrency());
+
+	for (int i = 0; i < numOfThreads; i++)
+	{
+		workers.emplace_back(new Worker);
+		workers.back()->begin = workers.back()->end = 0;
+	}
+	for (int i = 1; i < numOfThreads; i++)
+		threads.emplace_back(&HoughBatch::loop, this, (size_t)i);
+}
+
+HoughBatch::~HoughBatch()
+{
+	{
+		lock_guard<mutex> lock(m);
+		stop = true;
+	}
+	wake.notify_all();
+	for (auto &t : threads)
+		t.join();
+}
+
+const vector<HoughResult> &HoughBatch::process(const vector<ImageView<const unsigned char>> &images)
+{
+	const size_t n = images.size();
+	const size_t numOfWorkers = workers.size();
+	results.resize(n);
+
+	// one block of consecutive images per worker
+	for (size_t k = 0; k < numOfWorkers; k++)
+	{
+		workers[k]->begin = n * k / numOfWorkers;
+		workers[k]->end = n * (k + 1) / numOfWorkers;
+	}
+
+	{
+		lock_guard<mutex> lock(m);
+		this->images = &images;
+		error = nullptr;
+		running = (int)threads.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	// the calling thread works as well
+	work(0);
+
+	unique_lock<mutex> lock(m);
+	done.wait(lock, [this] { return running == 0; });
+	this->images = nullptr;
+	if (error)
+		rethrow_exception(error);
+	return results;
+}
+
+bool HoughBatch::take(const size_t self, size_t &i)
+{
+	// own images first, in order
+	{
+		Worker &w = *workers[self];
+		lock_guard<mutex> lock(w.m);
+		if (w.begin < w.end)
+		{
+			i = w.begin++;
+			return true;
+		}
+	}
+
+	// then the last image of the next worker with images left
+	const size_t numOfWorkers = workers.size();
+	for (size_t k = 1; k < numOfWorkers; k++)
+	{
+		Worker &v = *workers[(self + k) % numOfWorkers];
+		lock_guard<mutex> lock(v.m);
+		if (v.begin < v.end)
+		{
+			i = --v.end;
+			return true;
+		}
+	}
+	return false;
+}
+
+void HoughBatch::detect(Worker &w, const size_t i)
+{
+	const ImageView<const unsigned char> &image = (*images)[i];
+	HoughResult &r = results[i];
+	const auto start = chrono::steady_clock::now();
+
+	// the workspace of the worker is replaced only for images of another size
+	if (!w.transform || w.transform->width != image.width || w.transform->height != image.height)
+	{
+		w.transform.reset();
+		w.transform.reset(new HoughTransform(image.width, image.height, parameters.thetaResolution));
+		w.transform->setFrontEnd(parameters.frontEnd);
+	}
+
+	r.lines = w.transform->process(image, parameters.numOfLines, parameters.fillGap, parameters.minLength,
+		parameters.mode, parameters.angleWindow);
+	r.edges = w.transform->edgeCount();
+	r.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void HoughBatch::work(const size_t self)
+{
+	Worker &w = *workers[self];
+	size_t i;
+	while (take(self, i))
+	{
+		try
+		{
+			detect(w, i);
+		}
+		catch (...)
+		{
+			// keep the first error, the other images are still processed
+			lock_guard<mutex> lock(m);
+			if (!error)
+				error = current_exception();
+		}
+	}
+}
+
+void HoughBatch::loop(const size_t self)
+{
+	unsigned seen = 0;
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m);
+			wake.wait(lock, [&] { return stop || generation != seen; });
+			if (stop)
+				return;
+			seen = generation;
+		}
+
+		work(self);
+
+		lock_guard<mutex> lock(m);
+		if (--running == 0)
+			done.notify_one();
+	}
+}
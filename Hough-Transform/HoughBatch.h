@@ -0,0 +1,87 @@
+#ifndef _HOUGHBATCH_H
+#define _HOUGHBATCH_H
+
+#include <array>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "HoughTransform.h"
+#include "Image.h"
+
+using std::array;
+using std::vector;
+
+// parameters of the HoughTransform of every image of a batch, see HoughTransform::HoughLines
+struct HoughParameters
+{
+	int numOfLines = 1;
+	int fillGap = 20;
+	int minLength = 40;
+	HoughTransform::VotingMode mode = HoughTransform::FullVoting;
+	double angleWindow = 10;
+	double thetaResolution = 1.0;
+	HoughTransform::FrontEnd frontEnd = HoughTransform::FusedFilters;
+};
+
+// lines of one image of a batch
+struct HoughResult
+{
+	vector<array<int, 4>> lines;
+	size_t edges;		// number of edge pixels
+	double seconds;		// time spent on the image
+};
+
+// finds lines in many independent images at once. every worker owns a HoughTransform, kept
+// from one image to the next while their sizes agree, and runs it on one thread. the images
+// are split into one block per worker; a worker that finished its block steals the last
+// images of the others, so images of different sizes still keep all workers busy.
+class HoughBatch
+{
+public:
+	// numOfThreads includes the calling thread, 0 for one per hardware thread
+	HoughBatch(int numOfThreads = 0, const HoughParameters &parameters = HoughParameters());
+	HoughBatch(const HoughBatch&) = delete;
+	HoughBatch& operator=(const HoughBatch&) = delete;
+	~HoughBatch();
+
+	int size() const { return (int)workers.size(); }
+
+	// find lines in all images and return one result per image in the same order.
+	// an exception thrown for an image is rethrown here once all workers stopped.
+	const vector<HoughResult> &process(const vector<ImageView<const unsigned char>> &images);
+
+	const HoughParameters parameters;
+	vector<HoughResult> results;
+
+private:
+	struct Worker
+	{
+		std::mutex m;
+		size_t begin;	// images begin : end - 1 are not taken yet, the owner takes
+		size_t end;		// them from begin and other workers steal them from end
+		std::unique_ptr<HoughTransform> transform;
+	};
+
+	bool take(const size_t self, size_t &i);
+	void detect(Worker &w, const size_t i);
+	void work(const size_t self);	// detect images until none are left
+	void loop(const size_t self);	// body of the worker threads
+
+	vector<std::unique_ptr<Worker>> workers;	// worker 0 is the calling thread
+	vector<std::thread> threads;
+	const vector<ImageView<const unsigned char>> *images;
+	std::exception_ptr error;	// first exception of the current batch
+
+	std::mutex m;
+	std::condition_variable wake;
+	std::condition_variable done;
+	int running;			// threads not yet finished with the current batch
+	unsigned generation;	// incremented for every batch
+	bool stop;
+};
+
+#endif
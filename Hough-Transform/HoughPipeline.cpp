@@ -0,0 +1,190 @@
+#include "HoughPipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+HoughPipeline::Slot::Slot(const size_t w, const size_t h, const int nTheta, const int nRho, const HoughParameters &p) :
+	transform(new HoughTransform(w, h, p.thetaResolution)), M(nTheta, nRho)
+{
+	transform->setFrontEnd(p.frontEnd);
+}
+
+HoughPipeline::HoughPipeline(size_t w, size_t h, const HoughParameters &parameters, const int depth) :
+	width(w), height(h), parameters(parameters), trig(parameters.thetaResolution),
+	rRange(2 * (int)ceil(sqrt(w*w + h*h)) + 1), pushed(0), popped(0), stop(false)
+{
+	if (parameters.frontEnd == HoughTransform::StreamingFilters)
+		throw invalid_argument("HoughPipeline: StreamingFilters can not be split into stages");
+	if (depth < 1)
+		throw invalid_argument("HoughPipeline: depth must be at least 1");
+
+	for (int i = 0; i < depth; i++)
+		slots.emplace_back(new Slot(w, h, trig.size, rRange, parameters));
+	// every queue can hold all slots, so pushing a slot never fails
+	for (int k = 0; k <= numOfStages; k++)
+		queues.emplace_back(new SpscQueue<int>(depth));
+
+	const char *names[numOfStages] = { "filter", "vote", "lines" };
+	for (int k = 0; k < numOfStages; k++)
+	{
+		Stage &stage = stages[k];
+		stage.name = names[k];
+		stage.input = queues[k].get();
+		stage.output = queues[k + 1].get();
+		stage.frames = 0;
+		stage.busy = 0;
+		stage.wait = 0;
+		stage.maxQueueDepth = 0;
+	}
+	for (int k = 0; k < numOfStages; k++)
+		stages[k].thread = thread(&HoughPipeline::run, this, ref(stages[k]), k);
+}
+
+HoughPipeline::~HoughPipeline()
+{
+	stop = true;
+	for (auto &stage : stages)
+		stage.thread.join();
+}
+
+bool HoughPipeline::push(const ImageView<const unsigned char> &frame)
+{
+	if (frame.width != width || frame.height != height)
+		throw invalid_argument("HoughPipeline::push: frame size differs from the pipeline");
+	if (inFlight() == depth())
+		return false;
+
+	const int k = (int)(pushed % slots.size());
+	Slot &s = *slots[k];
+	s.frame = frame;
+	s.error = nullptr;
+	s.start = Clock::now();
+	pushed++;
+	queues[FilterStage]->push(k);
+	return true;
+}
+
+const HoughResult &HoughPipeline::pop()
+{
+	if (inFlight() == 0)
+		throw logic_error("HoughPipeline::pop: no frame in flight");
+
+	// slots leave the last stage in the order they were pushed
+	int k;
+	take(*queues[numOfStages], k);
+	popped++;
+
+	Slot &s = *slots[k];
+	s.result.seconds = chrono::duration<double>(Clock::now() - s.start).count();
+	if (s.error)
+		rethrow_exception(s.error);
+	return s.result;
+}
+
+bool HoughPipeline::take(SpscQueue<int> &q, int &slot)
+{
+	// spin briefly for frames close behind, then sleep so an idle pipeline costs little
+	for (int spins = 0; !q.pop(slot); spins++)
+	{
+		if (stop)
+			return false;
+		if (spins < 64)
+			this_thread::yield();
+		else
+			this_thread::sleep_for(chrono::microseconds(50));
+	}
+	return true;
+}
+
+void HoughPipeline::filter(Slot &s)
+{
+	s.transform->img = s.frame;
+	s.transform->findEdges();
+}
+
+void HoughPipeline::vote(Slot &s)
+{
+	s.M.clear();
+	s.transform->voteEdges(s.M, 0, 0, parameters.mode, parameters.angleWindow);
+}
+
+void HoughPipeline::lines(Slot &s)
+{
+	const EdgeList &edges = s.transform->edgeList();
+
+	s.M.findPeaks(parameters.numOfLines, HoughTransform::peakThetaHood, HoughTransform::peakRhoHood, s.peaks);
+	s.segments.index(edges, s.peaks, trig, (rRange - 1) / 2);
+	s.result.lines.clear();
+	s.segments.extract(edges, parameters.fillGap, parameters.minLength, 0, 0, s.result.lines);
+	s.result.edges = edges.size();
+}
+
+void HoughPipeline::run(Stage &stage, const int index)
+{
+	while (true)
+	{
+		const auto waitStart = Clock::now();
+		int k;
+		if (!take(*stage.input, k))
+			return;
+		const auto start = Clock::now();
+
+		// frames in the queue including the one just taken
+		const size_t queued = stage.input->size() + 1;
+		if (queued > stage.maxQueueDepth)
+			stage.maxQueueDepth = queued;
+
+		// a frame that failed in an earlier stage is passed on to pop
+		Slot &s = *slots[k];
+		if (!s.error)
+		{
+			try
+			{
+				if (index == FilterStage)
+					filter(s);
+				else if (index == VoteStage)
+					vote(s);
+				else
+					lines(s);
+			}
+			catch (...)
+			{
+				s.error = current_exception();
+			}
+		}
+
+		const auto end = Clock::now();
+		stage.busy += chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+		stage.wait += chrono::duration_cast<chrono::nanoseconds>(start - waitStart).count();
+		stage.frames++;
+		stage.output->push(k);
+	}
+}
+
+vector<HoughPipeline::StageStats> HoughPipeline::stats() const
+{
+	vector<StageStats> result;
+	for (const auto &stage : stages)
+	{
+		StageStats s;
+		s.name = stage.name;
+		s.frames = stage.frames;
+		s.busySeconds = stage.busy * 1e-9;
+		s.waitSeconds = stage.wait * 1e-9;
+		s.queueDepth = stage.input->size();	// approximate, the queue is not locked
+		s.maxQueueDepth = stage.maxQueueDepth;
+		result.push_back(s);
+	}
+	return result;
+}
+
+size_t HoughPipeline::memoryUsed() const
+{
+	size_t bytes = 0;
+	for (const auto &s : slots)
+		bytes += s->transform->memoryUsed() + s->M.rows() * s->M.stride() * sizeof(int);
+	return bytes;
+}
@@ -0,0 +1,119 @@
+#ifndef _HOUGHPIPELINE_H
+#define _HOUGHPIPELINE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "HoughAccumulator.h"
+#include "HoughBatch.h"
+#include "HoughSegments.h"
+#include "HoughTransform.h"
+#include "Image.h"
+#include "SpscQueue.h"
+#include "TrigTable.h"
+
+using std::array;
+using std::vector;
+
+// finds lines in a stream of frames with the stages of HoughLines on their own threads:
+// filtering and thresholding, voting, then peaks and segments. frames pass between the
+// stages through lock-free queues, so frame n can be voted while frame n + 1 is filtered.
+// every frame in flight owns one of depth slots with its own HoughTransform and voting
+// matrix, which bounds both the memory and the latency to depth frames.
+class HoughPipeline
+{
+public:
+	// frames of w x h pixels. parameters.frontEnd can not be StreamingFilters, which has no stages.
+	HoughPipeline(size_t w, size_t h, const HoughParameters &parameters = HoughParameters(), const int depth = 3);
+	HoughPipeline(const HoughPipeline&) = delete;
+	HoughPipeline& operator=(const HoughPipeline&) = delete;
+	~HoughPipeline();
+
+	const size_t width;
+	const size_t height;
+	const HoughParameters parameters;
+
+	int depth() const { return (int)slots.size(); }
+	int inFlight() const { return (int)(pushed - popped); }
+
+	// start finding lines in frame, false if depth frames are in flight already.
+	// the pixels are read in place, so they must not change until the result is popped.
+	bool push(const ImageView<const unsigned char> &frame);
+
+	// wait for the result of the oldest frame in flight. seconds is the time since its push.
+	// the result stays valid until the next push. an exception of the frame is rethrown here.
+	const HoughResult &pop();
+
+	// per stage counters since construction. queueDepth is the number of frames waiting
+	// for the stage, approximate as the stages keep running while it is read. maxQueueDepth is
+	// the most frames seen in the queue when the stage took one, including the one it took.
+	// waitSeconds is the time the stage had no frame to work on.
+	struct StageStats
+	{
+		const char *name;
+		size_t frames;
+		double busySeconds;
+		double waitSeconds;
+		size_t queueDepth;
+		size_t maxQueueDepth;
+	};
+	vector<StageStats> stats() const;
+
+	// bytes of the planes and voting matrices of all slots
+	size_t memoryUsed() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Slot
+	{
+		std::unique_ptr<HoughTransform> transform;
+		HoughAccumulator M;
+		vector<HoughPeak> peaks;
+		HoughSegments segments;
+		ImageView<const unsigned char> frame;
+		Clock::time_point start;
+		std::exception_ptr error;
+		HoughResult result;
+
+		Slot(const size_t w, const size_t h, const int nTheta, const int nRho, const HoughParameters &p);
+	};
+
+	struct Stage
+	{
+		const char *name;
+		SpscQueue<int> *input;
+		SpscQueue<int> *output;
+		std::atomic<size_t> frames;
+		std::atomic<long long> busy;	// nanoseconds
+		std::atomic<long long> wait;
+		std::atomic<size_t> maxQueueDepth;
+		std::thread thread;
+	};
+
+	enum { FilterStage, VoteStage, LinesStage, numOfStages };
+
+	void filter(Slot &s);
+	void vote(Slot &s);
+	void lines(Slot &s);
+	void run(Stage &stage, const int index);	// body of the stage threads
+	bool take(SpscQueue<int> &q, int &slot);	// wait for a slot, false once the pipeline stops
+
+	const TrigTable trig;
+	const int rRange;
+	vector<std::unique_ptr<Slot>> slots;
+	// queues[k] feeds stage k, the last one returns finished frames to pop
+	vector<std::unique_ptr<SpscQueue<int>>> queues;
+	Stage stages[numOfStages];
+
+	size_t pushed;	// frames pushed and popped so far, frame n uses slot n % depth
+	size_t popped;
+	std::atomic<bool> stop;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+
+#include "HoughSegments.h"
+
+using namespace std;
+
+void HoughSegments::clear()
+{
+	pixelStart.clear();
+	pixelIndex.clear();
+}
+
+void HoughSegments::index(const EdgeList &edges, const vector<HoughPeak> &peaks, const TrigTable &trig, const int rOffset)
+{
+	// index the edge pixels belonging to the Hough transfrom bin of every peak in
+	// compressed sparse row form.
+	// one pass counts the pixels of every peak and a second one fills in the indices.
+	// peaks are visited sorted by theta so r is computed once per distinct theta bin.
+	const int nPeaks = (int)peaks.size();
+	const double *cosT = trig.cosTable();
+	const double *sinT = trig.sinTable();
+
+	peakOrder.resize(nPeaks);
+	for (int k = 0; k < nPeaks; k++)
+		peakOrder[k] = k;
+	sort(peakOrder.begin(), peakOrder.end(), [&](const int i, const int j) { return peaks[i].a < peaks[j].a; });
+
+	pixelStart.assign(nPeaks + 1, 0);
+	pixelCursor.resize(nPeaks);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int e = 0; e < (int)edges.size(); e++)
+		{
+			const int x = edges.x[e];
+			const int y = edges.y[e];
+			int a = -1;
+			int r = 0;
+			for (const int k : peakOrder)
+			{
+				if (peaks[k].a != a)
+				{
+					a = peaks[k].a;
+					r = (int)round(x*cosT[a] + y*sinT[a]) + rOffset;
+				}
+				if (peaks[k].r != r)
+					continue;
+
+				if (pass == 0)
+					pixelStart[k + 1]++;
+				else
+					pixelIndex[pixelCursor[k]++] = e;
+			}
+		}
+
+		if (pass == 0)
+		{
+			for (int k = 0; k < nPeaks; k++)
+			{
+				pixelStart[k + 1] += pixelStart[k];
+				pixelCursor[k] = pixelStart[k];
+			}
+			pixelIndex.resize(pixelStart[nPeaks]);
+		}
+	}
+}
+
+void HoughSegments::extract(const EdgeList &edges, const int fillGap, const int minLength, const int x0, const int y0,
+	vector<array<int, 4>> &lines) const
+{
+	const int nPeaks = pixelStart.empty() ? 0 : (int)pixelStart.size() - 1;
+	for (int k = 0; k < nPeaks; k++)
+	{
+		// image pixel coordinates belonging the Hough transfrom bin of the peak
+		const int *pixels = pixelIndex.data() + pixelStart[k];
+		const int n = pixelStart[k + 1] - pixelStart[k];
+		if (n == 0)
+			break;
+
+		auto dist2 = [&](const int i, const int j)
+		{
+			const int dx = edges.x[pixels[i]] - edges.x[pixels[j]];
+			const int dy = edges.y[pixels[i]] - edges.y[pixels[j]];
+			return dx*dx + dy*dy;
+		};
+		auto push = [&](const int i, const int j)
+		{
+			lines.push_back({ x0 + edges.x[pixels[i]], y0 + edges.y[pixels[i]],
+				x0 + edges.x[pixels[j]], y0 + edges.y[pixels[j]] });
+		};
+
+		int gap, length;
+		
+		// store the temporary starting and ending points
+		int q1 = 0;
+		int q2 = 0;
+		
+		// find gaps between line segments that are larger than threshold
+		for (int i = 0; i < n - 1; i++)
+		{
+			gap = dist2(i, i + 1);
+			if (gap > fillGap*fillGap)
+			{
+				q2 = i;
+				length = dist2(q1, q2);
+				if (length >= minLength*minLength)
+					push(q1, q2);
+				// reset the starting and ending points
+				q1 = i + 1;
+				q2 = i + 1;
+			}
+		}
+		// if no large gap found, push the line
+		if (q1 == q2)
+		{
+			q2 = n - 1;
+			length = dist2(q1, q2);
+			if (length >= minLength*minLength)
+				push(q1, q2);
+		}
+
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef _HOUGHSEGMENTS_H
+#define _HOUGHSEGMENTS_H
+
+#include <array>
+#include <vector>
+
+#include "EdgeList.h"
+#include "HoughAccumulator.h"
+#include "TrigTable.h"
+
+using std::array;
+using std::vector;
+
+// line segments of the peaks of a Hough transform matrix. the edge pixels voting for
+// the bin of every peak are indexed, then walked in raster order and split at large gaps.
+// the index is kept between calls, so a reused object stops allocating.
+class HoughSegments
+{
+public:
+	// index the edge pixels belonging to the bin of every peak. rOffset is the rho bin of r = 0.
+	void index(const EdgeList &edges, const vector<HoughPeak> &peaks, const TrigTable &trig, const int rOffset);
+
+	// append the segments of the indexed peaks to lines as [x1, y1, x2, y2], moved by (x0, y0).
+	// if the gap between colinear segments are smaller than fillGap, connect them.
+	// if the merged line is shorter than minLength, discard it.
+	void extract(const EdgeList &edges, const int fillGap, const int minLength, const int x0, const int y0,
+		vector<array<int, 4>> &lines) const;
+
+	void clear();
+
+	// number of edge pixels of peaks[k] of the last index
+	int pixelCount(const int k) const { return pixelStart[k + 1] - pixelStart[k]; }
+
+private:
+	// the pixels of peaks[k] are the edge list entries
+	// pixelIndex[pixelStart[k]] : pixelIndex[pixelStart[k + 1] - 1], in raster order
+	vector<int> pixelStart;
+	vector<int> pixelIndex;
+	vector<int> pixelCursor;
+	vector<int> peakOrder;
+};
+
+#endif
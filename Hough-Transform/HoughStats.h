@@ -0,0 +1,64 @@
+#ifndef _HOUGHSTATS_H
+#define _HOUGHSTATS_H
+
+#include <chrono>
+#include <vector>
+
+using std::vector;
+
+// wall time and counters of the stages of one call of HoughTransform::HoughLines.
+// they are only recorded when HOUGH_STATS is defined, otherwise every field stays zero
+// and the instrumentation compiles to nothing.
+struct HoughStats
+{
+	double filterSeconds = 0;		// Gaussian and Sobel filters, one pass except with ReferenceFilters
+	double gaussianSeconds = 0;		// part of filterSeconds spent in GaussianFilter, ReferenceFilters only
+	double suppressionSeconds = 0;	// non maximum suppression
+	double thresholdSeconds = 0;	// histogram, thresholds and hysteresis
+	double voteSeconds = 0;			// voting, including the reduction of per-thread matrices
+	double peakSeconds = 0;
+	double segmentSeconds = 0;		// indexing the pixels of the peaks and extracting segments
+	double totalSeconds = 0;
+
+	size_t edges = 0;				// edge pixels
+	size_t votes = 0;				// votes cast into the matrix
+	int accumulatorMax = 0;			// votes of the strongest bin
+	size_t peaks = 0;
+	vector<int> peakPixels;			// edge pixels on the bin of every peak
+
+	// set everything to zero, keeping the capacity of peakPixels
+	void clear()
+	{
+		filterSeconds = gaussianSeconds = suppressionSeconds = thresholdSeconds = 0;
+		voteSeconds = peakSeconds = segmentSeconds = totalSeconds = 0;
+		edges = votes = peaks = 0;
+		accumulatorMax = 0;
+		peakPixels.clear();
+	}
+};
+
+// adds the time from its construction to its destruction to seconds
+class StageTimer
+{
+public:
+	StageTimer(double &seconds) : seconds(seconds), start(std::chrono::steady_clock::now()) {}
+	StageTimer(const StageTimer&) = delete;
+	StageTimer& operator=(const StageTimer&) = delete;
+	~StageTimer() { seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+private:
+	double &seconds;
+	const std::chrono::steady_clock::time_point start;
+};
+
+// HOUGH_STAGE_TIME(field) times the rest of the enclosing block into stats.field,
+// HOUGH_STAT(statements) runs statements, both only when HOUGH_STATS is defined
+#ifdef HOUGH_STATS
+#define HOUGH_STAGE_TIME(field) StageTimer stageTimer_##field(stats.field)
+#define HOUGH_STAT(...) __VA_ARGS__
+#else
+#define HOUGH_STAGE_TIME(field)
+#define HOUGH_STAT(...)
+#endif
+
+#endif
@@ -1,38 +1,204 @@
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <stdexcept>
 
+#include "Filters.h"
 #include "HoughTransform.h"
+#include "WorkerPool.h"
 
 using namespace std;
 
-const double pi = 3.14159265;
+// bytes of all planes setFrontEnd and the constructor take from the arena
+static size_t workspaceBytes(const size_t w, const size_t h)
+{
+	const size_t wh = w*h;
+	auto plane = [](const size_t bytes) { return roundUp(bytes, CACHE_LINE); };
+	return 8 * plane(wh * sizeof(float)) + plane(13 * w * sizeof(float))		// float filters
+		+ plane(9 * w * sizeof(float))												// streaming rows
+		+ 3 * plane(wh * sizeof(short)) + plane(wh) + plane(13 * w * sizeof(short))	// fixed-point filters
+		+ 3 * plane(max((w + 63) / 64 * h, (size_t)1) * sizeof(uint64_t));			// bit images
+}
+
+// part of the frame processed for roi, its bounds and the filter margin, clipped to the frame
+static Rect processedRegion(const size_t frameWidth, const size_t frameHeight, const Roi &roi)
+{
+	const Rect &b = roi.bounds();
+	if (max(b.x, 0) >= min(b.x + b.width, (int)frameWidth) || max(b.y, 0) >= min(b.y + b.height, (int)frameHeight))
+		throw invalid_argument("HoughTransform: region of interest outside the frame");
+	const int x0 = max(b.x - HoughTransform::filterMargin, 0);
+	const int y0 = max(b.y - HoughTransform::filterMargin, 0);
+	const int x1 = min(b.x + b.width + HoughTransform::filterMargin, (int)frameWidth);
+	const int y1 = min(b.y + b.height + HoughTransform::filterMargin, (int)frameHeight);
+	return { x0, y0, max(x1 - x0, 0), max(y1 - y0, 0) };
+}
 
-HoughTransform::HoughTransform(size_t w, size_t h) :width(w), height(h)
+HoughTransform::HoughTransform(size_t w, size_t h, const double thetaResolution, const HoughAccumulator::Layout layout) :
+	HoughTransform(Rect{ 0, 0, (int)w, (int)h }, w, h, thetaResolution, layout)
 {
-	filteredImg = new float[width*height];		// Gaussian filtered image
-	edgeAmp = new float[width*height];			// amplitute of soble edge
-	edgeAngle = new int[width*height];;			// angle of soble edge
-	imgSuppressed = new float[width*height];	// non maximum suppressed edge image
-	binaryImage = new bool[width*height];		// binary image
+}
+
+HoughTransform::HoughTransform(size_t frameWidth, size_t frameHeight, const Roi &roi, const double thetaResolution,
+	const HoughAccumulator::Layout layout) :
+	HoughTransform(processedRegion(frameWidth, frameHeight, roi), frameWidth, frameHeight, thetaResolution, layout)
+{
+	// edges are kept inside the region only, unless it covers all processed pixels
+	const Rect &b = roi.bounds();
+	if (!roi.isRect() || b.x > region.x || b.y > region.y ||
+		b.x + b.width < region.x + (int)width || b.y + b.height < region.y + (int)height)
+	{
+		roiMask.reset(new BitImage(width, height, &arena));
+		roi.rasterize(*roiMask, region.x, region.y);
+	}
+}
 
+HoughTransform::HoughTransform(const Rect &r, size_t frameWidth, size_t frameHeight, const double thetaResolution,
+	const HoughAccumulator::Layout layout) :
+	width(r.width), height(r.height), region(r), frameWidth(frameWidth), frameHeight(frameHeight),
+	arena(workspaceBytes(width, height)), binaryImage(width, height, &arena), weakImage(width, height, &arena), trig(thetaResolution),
 	// initialize rThetaM
-	rRange = 2*ceil(sqrt(width*width + height*height)) + 1;
-	// theta = -90 : 1 : 89
-	// set up size. (180 x rRange)
-	
-	rThetaM.resize(180);
-	for (int i = 0; i < 180; i++)
-		rThetaM[i].resize(rRange);	
+	// theta = -90 : thetaResolution : 90 - thetaResolution
+	// set up size. (trig.size x rRange)
+	rRange(2 * (int)ceil(sqrt(width*width + height*height)) + 1), rThetaM(trig.size, rRange, layout), frontEnd(FusedFilters),
+	previousThresholds(false), haveThresholds(false), streamHigh(0), streamLow(0)
+{
+	filteredImg = nullptr;
+	edgeAmp = nullptr;
+	edgeSlope = nullptr;
+	rowBuffers = nullptr;
+	imgSuppressed = nullptr;
+	referenceScratch = nullptr;
+	streamBuffers = nullptr;
+
+	edgeAmpInt = nullptr;
+	GxInt = nullptr;
+	GyInt = nullptr;
+	imgSuppressedInt = nullptr;
+	rowBuffersInt = nullptr;
+
+	setFrontEnd(frontEnd);
 }
 
 HoughTransform::~HoughTransform()
 {
-	delete[] filteredImg;
-	delete[] edgeAmp;
-	delete[] edgeAngle;
-	delete[] imgSuppressed;
-	delete[] binaryImage;
+	// the planes are freed with the arena
+}
+
+void HoughTransform::setNumThreads(int n)
+{
+	// n = 0 uses one thread per hardware thread
+	if (n <= 0)
+		n = max(1, (int)std::thread::hardware_concurrency());
+
+	if (n == 1)
+		pool.reset();
+	else if (!pool || pool->size() != n)
+		pool.reset(new WorkerPool(n));
+}
+
+void HoughTransform::setFrontEnd(const FrontEnd f)
+{
+	frontEnd = f;
+
+	// planes are taken from the arena the first time a front end needs them
+	const size_t wh = width*height;
+	if ((f == ReferenceFilters || f == FusedFilters) && edgeAmp == nullptr)
+	{
+		edgeAmp = arena.alloc<float>(wh);			// amplitute of soble edge
+		edgeSlope = arena.alloc<float>(wh);			// slope of soble gradient
+		imgSuppressed = arena.alloc<float>(wh);		// non maximum suppressed edge image
+	}
+	if ((f == FusedFilters || f == StreamingFilters) && rowBuffers == nullptr)
+	{
+		rowBuffers = arena.alloc<float>(13 * width);	// rolling rows of GaussianSobel, the last one stays zero
+		memset(rowBuffers, 0, 13 * width*sizeof(float));
+	}
+	if (f == StreamingFilters && streamBuffers == nullptr)
+		streamBuffers = arena.alloc<float>(9 * width);
+	if (f == ReferenceFilters && filteredImg == nullptr)
+	{
+		filteredImg = arena.alloc<float>(wh);		// Gaussian filtered image
+		referenceScratch = arena.alloc<float>(4 * wh);
+	}
+	if (f == IntegerFilters && edgeAmpInt == nullptr)
+	{
+		edgeAmpInt = arena.alloc<short>(wh);
+		GxInt = arena.alloc<short>(wh);
+		GyInt = arena.alloc<short>(wh);
+		imgSuppressedInt = arena.alloc<unsigned char>(wh);
+		rowBuffersInt = arena.alloc<short>(13 * width);
+		memset(rowBuffersInt, 0, 13 * width*sizeof(short));
+	}
+}
+
+size_t HoughTransform::memoryUsed() const
+{
+	return arena.used() + (1 + partialM.size()) * rThetaM.rows() * rThetaM.stride() * sizeof(int);
+}
+
+void HoughTransform::setStreamingThresholds(const bool previousFrame)
+{
+	previousThresholds = previousFrame;
+	haveThresholds = false;
+}
+
+void HoughTransform::reset()
+{
+	lines.clear();
+	peaks.clear();
+	edges.clear();
+	segments.clear();
+}
+
+const vector<array<int, 4>> &HoughTransform::process(const ImageView<const unsigned char> &frame, const int numOfLines,
+	const int fillGap, const int minLength, const VotingMode mode, const double angleWindow)
+{
+	if (frame.width != frameWidth || frame.height != frameHeight)
+		throw invalid_argument("HoughTransform::process: frame size differs from the transform");
+
+	img = frame.sub(region.x, region.y, width, height);
+	HoughLines(numOfLines, fillGap, minLength, mode, angleWindow);
+	return lines;
+}
+
+const vector<array<int, 4>> &HoughTransform::process(const unsigned char *frame, const int numOfLines, const int fillGap,
+	const int minLength, const VotingMode mode, const double angleWindow)
+{
+	return process(ImageView<const unsigned char>(frame, frameWidth, frameHeight), numOfLines, fillGap, minLength, mode, angleWindow);
+}
+
+void HoughTransform::filterEdges()
+{
+	if (frontEnd == StreamingFilters)
+		throw invalid_argument("HoughTransform::filterEdges: StreamingFilters can not be split into stages");
+	if (frontEnd == IntegerFilters)
+	{
+		{
+			HOUGH_STAGE_TIME(filterSeconds);
+			GaussianSobelInt();
+		}
+		HOUGH_STAGE_TIME(suppressionSeconds);
+		NonMaxSuppressionInt();
+	}
+	else
+	{
+		{
+			HOUGH_STAGE_TIME(filterSeconds);
+			if (frontEnd == FusedFilters)
+				GaussianSobel();
+			else
+			{
+				{
+					HOUGH_STAGE_TIME(gaussianSeconds);
+					GaussianFilter();
+				}
+				SobelEdge();
+			}
+		}
+		HOUGH_STAGE_TIME(suppressionSeconds);
+		NonMaxSuppression();
+	}
 }
 
 void HoughTransform::GaussianFilter()
@@ -42,9 +208,9 @@ void HoughTransform::GaussianFilter()
 	const size_t w = width;
 	const size_t h = height;
 
-	float *tmp = new float[w*h];
+	float *tmp = referenceScratch;
 
-	float filter[] = { 0.0545f, 0.2442f, 0.4026f, 0.2442f, 0.0545f }; //Gaussian filter, width=5, sigma=1
+	const float *filter = gaussianKernel; //Gaussian filter, width=5, sigma=1
 
 																	  // convolve along horizontal direction
 	size_t index = 0;
@@ -58,7 +224,7 @@ void HoughTransform::GaussianFilter()
 				if (j + k >= 0 && j + k < w)
 				{
 					index = i*w + j + k;
-					value += filter[k + 2] * img[index];
+					value += filter[k + 2] * img(j + k, i);
 				}
 			}
 			tmp[i*w + j] = value;
@@ -79,7 +245,6 @@ void HoughTransform::GaussianFilter()
 			}
 			filteredImg[i*w + j] = value;
 		}
-	delete[] tmp;
 }
 
 void HoughTransform::SobelEdge()
@@ -92,14 +257,14 @@ void HoughTransform::SobelEdge()
 	const size_t w = width;
 	const size_t h = height;
 
-	float *Gx = new float[h * w]; // gradient along x
-	float *Gy = new float[h * w]; // gradient along y	
+	float *Gx = referenceScratch + 2 * h * w; // gradient along x
+	float *Gy = referenceScratch + 3 * h * w; // gradient along y	
 
 	int A[3] = { 1, 0, -1 }; // filter kernel
 	int B[3] = { 1, 2, 1 };
 
-	float *g_1 = new float[h * w]; // temporary array
-	float *g_2 = new float[h * w];
+	float *g_1 = referenceScratch; // temporary array
+	float *g_2 = referenceScratch + h * w;
 
 	int r = 0, c = 0; // row and column index
 
@@ -148,40 +313,164 @@ void HoughTransform::SobelEdge()
 		}
 	}
 
-	float Gdiv = 0;
 	for (int i = 0; i < w * h; i++)
+		edgeSlope[i] = Gy[i] / Gx[i];
+}
+
+// row schedule shared by GaussianSobel and GaussianSobelInt: the image is filtered row by row,
+// keeping only the few rows each filter needs in 13 rolling buffers of w elements.
+// rows are kept in rings indexed by row number modulo the ring size, the last buffer stays zero.
+// finish(y, g1, g2) completes the Sobel operator of row y from the horizontal parts of rows y - 1 : y + 1
+template <typename T, typename Finish>
+static void filterRows(const ImageView<const unsigned char> &img, const int w, const int h, T *buffers,
+	void(*rowFilter)(const unsigned char *, T *, const int), void(*columnFilter)(const T *const[5], T *, const int),
+	void(*sobelRowFilter)(const T *, T *, T *, const int), Finish finish)
+{
+	T *smooth[5];	// horizontally filtered rows y - 2 : y + 2
+	T *g1[3];		// horizontal Sobel parts of filtered rows y - 1 : y + 1
+	T *g2[3];
+	for (int k = 0; k < 5; k++)
+		smooth[k] = buffers + k*w;
+	for (int k = 0; k < 3; k++)
+	{
+		g1[k] = buffers + (5 + k)*w;
+		g2[k] = buffers + (8 + k)*w;
+	}
+	T *filtered = buffers + 11 * w;
+	const T *zeros = buffers + 12 * w;
+
+	const T *rows[5];
+	const T *g1Rows[3];
+	const T *g2Rows[3];
+
+	for (int y = 0; y < 2 && y < h; y++)
+		rowFilter(img.row(y), smooth[y % 5], w);
+
+	// filter row y, then finish the Sobel operator of row y - 1
+	for (int y = 0; y <= h; y++)
 	{
-		/* directions
-		0: 90 degree
-		1: 135 degree
-		2: 0 degree
-		3: 45 degree
-		*/
-		Gdiv = Gy[i] / Gx[i];
-		if (Gdiv < 0)
+		if (y < h)
 		{
-			if (Gdiv < -2.41421356237)
-				edgeAngle[i] = 0;
-			else if (Gdiv < -0.414213562373)
-				edgeAngle[i] = 1;
-			else
-				edgeAngle[i] = 2;
+			if (y + 2 < h)
+				rowFilter(img.row(y + 2), smooth[(y + 2) % 5], w);
+			for (int k = 0; k < 5; k++)
+				rows[k] = y - 2 + k >= 0 && y - 2 + k < h ? smooth[(y - 2 + k) % 5] : zeros;
+			columnFilter(rows, filtered, w);
+			sobelRowFilter(filtered, g1[y % 3], g2[y % 3], w);
+		}
+
+		if (y > 0)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				const bool inside = y - 2 + k >= 0 && y - 2 + k < h;
+				g1Rows[k] = inside ? g1[(y - 2 + k) % 3] : zeros;
+				g2Rows[k] = inside ? g2[(y - 2 + k) % 3] : zeros;
+			}
+			finish(y - 1, g1Rows, g2Rows);
 		}
+	}
+}
+
+void HoughTransform::GaussianSobel()
+{
+	// fused GaussianFilter() and SobelEdge(), see filterRows
+	const int w = (int)width;
+	filterRows<float>(img, w, (int)height, rowBuffers, gaussianRow, gaussianColumn, sobelRow,
+		[&](const int y, const float *const g1[3], const float *const g2[3])
+	{
+		sobelColumn(g1, g2, edgeAmp + y*w, edgeSlope + y*w, w);
+	});
+}
+
+void HoughTransform::GaussianSobelInt()
+{
+	// fixed-point GaussianSobel, amplitudes are scaled by 16
+	const int w = (int)width;
+	filterRows<short>(img, w, (int)height, rowBuffersInt, gaussianRowInt, gaussianColumnInt, sobelRowInt,
+		[&](const int y, const short *const g1[3], const short *const g2[3])
+	{
+		sobelColumnInt(g1, g2, edgeAmpInt + y*w, GxInt + y*w, GyInt + y*w, w);
+	});
+}
+
+// quantize the gradient direction given by its slope Gy / Gx
+static int edgeDirection(const float Gdiv)
+{
+	/* directions
+	0: 90 degree
+	1: 135 degree
+	2: 0 degree
+	3: 45 degree
+	*/
+	if (Gdiv < 0)
+	{
+		if (Gdiv < -2.41421356237)
+			return 0;
+		else if (Gdiv < -0.414213562373)
+			return 1;
 		else
+			return 2;
+	}
+	else
+	{
+		if (Gdiv > 2.41421356237)
+			return 0;
+		else if (Gdiv > 0.414213562373)
+			return 3;
+		else
+			return 2;
+	}
+}
+
+// non maximum suppression of the pixels 1 : w - 2 of a row given the edge amplitudes of the
+// rows above, at and below it. the first and last pixels are set to zero.
+static void suppressRow(const float *const amp[3], const float *slope, float *out, const int w)
+{
+	const float *up = amp[0];
+	const float *mid = amp[1];
+	const float *down = amp[2];
+
+	for (int x = 1; x < w - 1; x++)
+	{
+		switch (edgeDirection(slope[x]))
 		{
-			if (Gdiv > 2.41421356237)
-				edgeAngle[i] = 0;
-			else if (Gdiv > 0.414213562373)
-				edgeAngle[i] = 3;
+		case 0: // 90 degree
+			if (mid[x] > up[x] && mid[x] > down[x])
+				out[x] = mid[x];
+			else
+				out[x] = 0;
+			break;
+		case 1: // 135 degree
+			if (mid[x] > up[x - 1] && mid[x] > down[x + 1])
+				out[x] = mid[x];
+			else
+				out[x] = 0;
+			break;
+		case 2: // 0 degree
+			if (mid[x] > mid[x - 1] && mid[x] > mid[x + 1])
+				out[x] = mid[x];
 			else
-				edgeAngle[i] = 2;
+				out[x] = 0;
+			break;
+		case 3: // 45 degree
+			if (mid[x] > up[x + 1] && mid[x] > down[x - 1])
+				out[x] = mid[x];
+			else
+				out[x] = 0;
+			break;
+		default:
+			std::cout << "error, edge angle out of range!" << std::endl;
+			break;
 		}
-	}
 
-	delete[] Gx;
-	delete[] Gy;
-	delete[] g_1;
-	delete[] g_2;
+		if (out[x] > 255)
+			out[x] = 255;
+	}
+	// set boundaries to zero. the first and last pixel of every row have no neighbours on
+	// one side, and they enter the histogram, so they must be written on every frame
+	out[0] = 0;
+	out[w - 1] = 0;
 }
 
 void HoughTransform::NonMaxSuppression()
@@ -189,69 +478,81 @@ void HoughTransform::NonMaxSuppression()
 	const size_t h = height;
 	const size_t w = width;
 
+	for (int y = 1; y < h - 1; y++)
+	{
+		const float *amp[3] = { edgeAmp + (y - 1)*w, edgeAmp + y*w, edgeAmp + (y + 1)*w };
+		suppressRow(amp, edgeSlope + y*w, imgSuppressed + y*w, (int)w);
+	}
+	// set boundaries to zero
+	for (int i = 0; i < w; i++)
+	{
+		imgSuppressed[i] = 0;
+		imgSuppressed[(h - 1)*w + i] = 0;
+	}
+}
+
+void HoughTransform::NonMaxSuppressionInt()
+{
+	// same as NonMaxSuppression on the fixed-point gradients. the direction is found
+	// without division, using tan(67.5 degree) ~ 618/256 and tan(22.5 degree) ~ 106/256
+	const int h = (int)height;
+	const int w = (int)width;
+
 	size_t index = 0;
 	for (int y = 1; y < h - 1; y++)
 		for (int x = 1; x < w - 1; x++)
 		{
 			index = y*w + x;
-			switch (edgeAngle[index])
-			{
-			case 0: // 90 degree
-				if (edgeAmp[index] > edgeAmp[index - w] && edgeAmp[index] > edgeAmp[index + w])
-					imgSuppressed[index] = edgeAmp[index];
-				else
-					imgSuppressed[index] = 0;
-				break;
-			case 1: // 135 degree
-				if (edgeAmp[index] > edgeAmp[index - w - 1] && edgeAmp[index] > edgeAmp[index + w + 1])
-					imgSuppressed[index] = edgeAmp[index];
-				else
-					imgSuppressed[index] = 0;
-				break;
-			case 2: // 0 degree
-				if (edgeAmp[index] > edgeAmp[index - 1] && edgeAmp[index] > edgeAmp[index + 1])
-					imgSuppressed[index] = edgeAmp[index];
-				else
-					imgSuppressed[index] = 0;
-				break;
-			case 3: // 45 degree
-				if (edgeAmp[index] > edgeAmp[index - w + 1] && edgeAmp[index] > edgeAmp[index + w - 1])
-					imgSuppressed[index] = edgeAmp[index];
-				else
-					imgSuppressed[index] = 0;
-				break;
-			default:
-				std::cout << "error, edge angle out of range!" << std::endl;
-				break;
-			}
-
-			if (imgSuppressed[index] > 255)
-				imgSuppressed[index] = 255;
+			const int ax = abs(GxInt[index]);
+			const int ay = abs(GyInt[index]);
+
+			// offset of the neighbours along the gradient
+			int offset;
+			if (ay * 256 > ax * 618) // 90 degree
+				offset = w;
+			else if (ay * 256 > ax * 106) // 135 or 45 degree
+				offset = (GxInt[index] < 0) != (GyInt[index] < 0) ? w + 1 : w - 1;
+			else // 0 degree
+				offset = 1;
+
+			const int amp = edgeAmpInt[index];
+			if (amp > edgeAmpInt[index - offset] && amp > edgeAmpInt[index + offset])
+				imgSuppressedInt[index] = (unsigned char)(amp >> 4 > 255 ? 255 : amp >> 4);
+			else
+				imgSuppressedInt[index] = 0;
 		}
 	// set boundaries to zero
 	for (int i = 0; i < w; i++)
 	{
-		imgSuppressed[i] = 0;
-		imgSuppressed[(h - 1)*w + i] = 0;
+		imgSuppressedInt[i] = 0;
+		imgSuppressedInt[(h - 1)*w + i] = 0;
 	}
 	for (int i = 1; i < h - 1; i++)
 	{
-		imgSuppressed[i*w] = 0;
-		imgSuppressed[i*w - 1] = 0;
+		imgSuppressedInt[i*w] = 0;
+		imgSuppressedInt[i*w + w - 1] = 0;
 	}
-
 }
 
-void HoughTransform::histogram()
+template <typename T>
+void HoughTransform::addHistogram(const T *suppressed, unsigned int h[256], const Rect &part) const
 {
-	for (int i = 0; i < 256; i++)
-		hist[i] = 0;
+	// with a region of interest only its pixels count, as only they can become edges
+	for (int i = part.y; i < part.y + part.height; i++)
+		for (int j = part.x; j < part.x + part.width; j++)
+			if (!roiMask || roiMask->test(j, i))
+				h[(unsigned char)(suppressed[i*width + j])]++;
+}
 
-	for (int i = 0; i < height*width; i++)
-		hist[(unsigned char)(imgSuppressed[i])]++;
+void HoughTransform::addHistogram(unsigned int h[256], const Rect &part) const
+{
+	if (frontEnd == IntegerFilters)
+		addHistogram(imgSuppressedInt, h, part);
+	else
+		addHistogram(imgSuppressed, h, part);
 }
 
-unsigned char HoughTransform::otsu()
+unsigned char HoughTransform::otsu(const unsigned int hist[256])
 {
 	// find a threshold level that maximizes the between-class variance
 	unsigned char level = 0;
@@ -314,294 +615,454 @@ unsigned char HoughTransform::percentile(const double p)
 	std::cout << "error percentile" << std::endl;
 }
 
-void HoughTransform::threshold()
+void HoughTransform::edgeThresholds(const unsigned int hist[256], unsigned char &high, unsigned char &low)
 {
-	const size_t h = height;
-	const size_t w = width;
-
-	histogram();
-
 	// high threshold
-	unsigned char high;
-	high = otsu();
+	high = otsu(hist);
 	// high = percentile(hist, 0.7);
 
 	//low threshold
-	unsigned char low = high * 0.4;
+	low = high * 0.4;
+}
+
+void HoughTransform::thresholdEdges(const unsigned char high, const unsigned char low, const Rect &part)
+{
+	if (frontEnd == IntegerFilters)
+		threshold(imgSuppressedInt, high, low, part);
+	else
+		threshold(imgSuppressed, high, low, part);
+}
 
-	bool *strong = new bool[h*w];
-	bool *weak = new bool[h*w];
+template <typename T>
+void HoughTransform::threshold(const T *suppressed, const unsigned char high, const unsigned char low, const Rect &part)
+{
+	const size_t h = height;
+	const size_t w = width;
 
-	for (int i = 0; i < h*w; i++)
+	// hysteresis: strong pixels are edges, weak pixels are edges if they are connected to
+	// a strong pixel through other weak pixels. the edges are grown from the strong pixels
+	// with a worklist, so the work is linear in the number of weak and strong pixels.
+	// with a thread pool every thread grows the edges inside a band of rows, then the edges
+	// crossing the band boundaries are grown from the boundary rows on the calling thread.
+	const int bands = pool ? pool->size() : 1;
+	if (bandWorklists.size() < (size_t)bands)
+		bandWorklists.resize(bands);
+
+	auto growBand = [&](const int b)
 	{
-		if (imgSuppressed[i] > high)
-		{
-			strong[i] = true;
-			weak[i] = false;
-		}
-		else if (imgSuppressed[i] > low)
+		const size_t y0 = h * b / bands;
+		const size_t y1 = h * (b + 1) / bands;
+		vector<int> &worklist = bandWorklists[b];
+		worklist.clear();
+
+		binaryImage.clearRows(y0, y1);
+		weakImage.clearRows(y0, y1);
+
+		// only pixels of part off the image border can be edges
+		const size_t i0 = max(max(y0, (size_t)1), (size_t)part.y);
+		const size_t i1 = min(min(y1, h - 1), (size_t)(part.y + part.height));
+		const size_t j0 = max((size_t)1, (size_t)part.x);
+		const size_t j1 = min(w - 1, (size_t)(part.x + part.width));
+		for (size_t i = i0; i < i1; i++)
 		{
-			weak[i] = true;
-			strong[i] = false;
-		}
-		else
-		{
-			strong[i] = false;
-			weak[i] = false;
+			uint64_t *weakRow = weakImage.row(i);
+			uint64_t *edgeRow = binaryImage.row(i);
+			for (size_t j = j0; j < j1; j++)
+			{
+				const size_t index = i*w + j;
+				if (suppressed[index] > low)
+				{
+					const uint64_t bit = (uint64_t)1 << (j & 63);
+					weakRow[j >> 6] |= bit;
+					if (suppressed[index] > high)
+					{
+						edgeRow[j >> 6] |= bit;
+						worklist.push_back((int)index);
+					}
+				}
+			}
 		}
+		hysteresis(worklist, y0, y1);
+	};
 
-		binaryImage[i] = false;
-	}
+	if (bands == 1)
+		growBand(0);
+	else
+	{
+		pool->parallelFor(bands, growBand);
 
-	size_t index = 0;
-	for (int i = 1; i < h - 1; i++)
-		for (int j = 1; j < w - 1; j++)
+		// every pixel connected to an edge inside the same band is already an edge,
+		// so the remaining ones can only be reached from the first or last row of a band
+		vector<int> &worklist = bandWorklists[0];
+		auto push = [&](const int x, const int y) { worklist.push_back(y*(int)w + x); };
+		for (int b = 0; b < bands; b++)
 		{
-			index = i*w + j;
-			if (strong[index])
-				binaryImage[index] = true;
-			else if (weak[index])
+			const size_t y0 = h * b / bands;
+			const size_t y1 = h * (b + 1) / bands;
+			if (y1 > y0)
 			{
-				// check 8-connected neighborhood pixels
-				if (strong[index + 1])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
-				if (strong[index + w + 1])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
-				if (strong[index + w])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
-				if (strong[index + w - 1])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
-				if (strong[index - 1])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
-				if (strong[index - w - 1])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
-				if (strong[index - w])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
-				if (strong[index - w + 1])
-				{
-					binaryImage[index] = true;
-					continue;
-				}
+				binaryImage.forEach(y0, y0 + 1, push);
+				if (y1 - 1 > y0)
+					binaryImage.forEach(y1 - 1, y1, push);
 			}
 		}
+		hysteresis(worklist, 0, h);
+	}
+
+	if (roiMask)
+		binaryImage &= *roiMask;
+
+	// collect the edge pixels in raster order
+	edges.clear();
+	edges.reserve(binaryImage.count());
+	binaryImage.forEach(0, h, [&](const int x, const int y) { edges.push_back(x, y); });
 
 }
 
-void HoughTransform::HoughMatrix()
+void HoughTransform::keepEdges(const Rect &part)
 {
-	// find lines using Hough transform
-	const size_t h = height;
-	const size_t w = width;	
+	size_t n = 0;
+	for (size_t e = 0; e < edges.size(); e++)
+	{
+		const int x = edges.x[e];
+		const int y = edges.y[e];
+		if (x >= part.x && x < part.x + part.width && y >= part.y && y < part.y + part.height)
+		{
+			edges.x[n] = x;
+			edges.y[n] = y;
+			n++;
+		}
+	}
+	edges.resize(n);
+}
 
-	// generate binary edge image for voting
-	GaussianFilter();
-	SobelEdge();
-	NonMaxSuppression();
-	threshold();
+void HoughTransform::hysteresis(vector<int> &worklist, const size_t y0, const size_t y1)
+{
+	// mark the weak pixels 8-connected to the pixels in worklist as edges, limited to rows y0 : y1 - 1.
+	// weak pixels are never on the image border, so only the rows need to be checked.
+	const int w = (int)width;
 
-	// populate rThetaM matrix using voting
-	size_t index = 0;	
-	int r;
-	for (int y = 0; y < h; y++)
+	while (!worklist.empty())
 	{
-		for (int x = 0; x < w; x++)
+		const int index = worklist.back();
+		worklist.pop_back();
+		const int y = index / w;
+		const int x = index - y*w;
+
+		for (int i = y - 1; i <= y + 1; i++)
 		{
-			index = y*w + x;
-			if (binaryImage[index])
-			{				
-				for (int a = -90; a < 90; a++)
+			if (i < (int)y0 || i >= (int)y1)
+				continue;
+			for (int j = x - 1; j <= x + 1; j++)
+				if (weakImage.test(j, i) && !binaryImage.test(j, i))
 				{
-					r = round(x*cos(a / 180.0*pi) + y*sin(a / 180.0*pi));
-					rThetaM[a+90][r + (rRange-1)/2]++;
+					binaryImage.set(j, i);
+					worklist.push_back(i*w + j);
 				}
-			}
 		}
-	}	
+	}
+}
+
+int HoughTransform::slopeBin(const double slope) const
+{
+	// the gradient is normal to the edge, so its direction is the theta of the line
+	// through the pixel. atan of the slope gives it in [-90, 90] degrees.
+	const double theta = atan(slope) * (180.0 / 3.14159265);
+	int a = (int)round((theta + 90) / trig.step);
+	return a >= trig.size ? a - trig.size : a;
+}
+
+int HoughTransform::gradientBin(const size_t index) const
+{
+	return slopeBin(frontEnd == IntegerFilters ? (double)GyInt[index] / GxInt[index] : edgeSlope[index]);
+}
+
+void HoughTransform::vote(const size_t e0, const size_t e1, HoughAccumulator &M, const int hood, const int x0, const int y0)
+{
+	const size_t w = width;
+	vote(e0, e1, M, hood, x0, y0, [&](const size_t e) { return gradientBin(edges.y[e] * w + edges.x[e]); });
 }
 
-vector<int> HoughTransform::findMax()
+template <typename Bin>
+void HoughTransform::vote(const size_t e0, const size_t e1, HoughAccumulator &M, const int hood, const int x0, const int y0,
+	Bin bin)
 {
-	vector<int> coord;
-	int aMax = 0;
-	int rMax = 0;
+	// cast the votes of edge pixels e0 : e1 - 1 of the edge list into M, moved by (x0, y0)
+	// hood < 0 votes for all theta bins, otherwise for hood bins on each side of the gradient
+	// bin(e) gives the theta bin of the gradient of edge pixel e
+	const int nTheta = trig.size;
+	const int rOffset = (M.nRho - 1) / 2;
+	const double *cosT = trig.cosTable();
+	const double *sinT = trig.sinTable();
+	// votes points at r = 0 and r may be negative, so the offsets are signed
+	const ptrdiff_t aStride = (ptrdiff_t)M.thetaStride();
+	const ptrdiff_t rStride = (ptrdiff_t)M.rhoStride();
+	int *votes = M.data() + rOffset*rStride;
+	const int *ex = edges.x.data();
+	const int *ey = edges.y.data();
+
+	int x, y, r;
+	for (size_t e = e0; e < e1; e++)
+	{
+		x = ex[e] + x0;
+		y = ey[e] + y0;
 
-	int max = 0;
-	int currentMax = 0;
-	for (int a = 0; a < 180; a++)
-		for(int r = 0; r < rRange; r++)
+		if (hood < 0)
 		{
-			if (rThetaM[a][r] > max)
+			for (int a = 0; a < nTheta; a++)
 			{
-				max = rThetaM[a][r];
-				aMax = a;
-				rMax = r;
+				r = round(x*cosT[a] + y*sinT[a]);
+				votes[a*aStride + (ptrdiff_t)r*rStride]++;
+			}
+		}
+		else
+		{
+			// theta bins out of bounds wrap around, the table gives the mirrored r
+			const int centre = bin(e);
+			for (int i = centre - hood; i <= centre + hood; i++)
+			{
+				const int a = i < 0 ? i + nTheta : (i >= nTheta ? i - nTheta : i);
+				r = round(x*cosT[a] + y*sinT[a]);
+				votes[a*aStride + (ptrdiff_t)r*rStride]++;
 			}
 		}
-	if (max > 0)
-	{
-		coord.push_back(max);
-		coord.push_back(aMax);
-		coord.push_back(rMax);
 	}
-	return coord;
 }
 
-void HoughTransform::HoughPeaks(const int numOfPeaks, const int hooda, const int hoodr)
-{	
-	// find peaks of Hough Transfrom matrix
-	// suppress the neighborhoods. neighborhoods window size equals (hooda*2+1)x(hoodr*2+1)
-	// modified from MATLAB
+int HoughTransform::votingHood(const VotingMode mode, const double angleWindow) const
+{
+	// number of theta bins on each side of the gradient direction
+	int hood = (int)ceil(angleWindow / trig.step);
+	if (mode != GradientVoting || 2 * hood + 1 >= trig.size)
+		hood = -1;
+	return hood;
+}
 
-	HoughMatrix();
+void HoughTransform::findEdges()
+{
+	filterEdges();
 
-	// find maximum value of rThetaM for thresholding	
-	int max = 0;
-	int currentMax = 0;
-	for (const auto& a : rThetaM)
+	HOUGH_STAGE_TIME(thresholdSeconds);
+	for (int i = 0; i < 256; i++)
+		hist[i] = 0;
+	addHistogram(hist, Rect{ 0, 0, (int)width, (int)height });
+	unsigned char high, low;
+	edgeThresholds(hist, high, low);
+	thresholdEdges(high, low, Rect{ 0, 0, (int)width, (int)height });
+}
+
+void HoughTransform::voteEdges(HoughAccumulator &M, const int x0, const int y0, const VotingMode mode, const double angleWindow)
+{
+	vote(0, edges.size(), M, votingHood(mode, angleWindow), x0, y0);
+}
+
+void HoughTransform::HoughMatrix(const VotingMode mode, const double angleWindow)
+{
+	// find lines using Hough transform
+	if (frontEnd == StreamingFilters)
 	{
-		currentMax = *max_element(a.cbegin(), a.cend());
-		max = currentMax > max ? currentMax : max;
+		// the stages run interleaved, so all of them are counted as filtering
+		HOUGH_STAGE_TIME(filterSeconds);
+		StreamMatrix(mode, angleWindow);
+		return;
 	}
-	int threshold = (int) (max / 2);
-	
-	// find peaks
-	int peakCount = 0;
-	vector<int> coord;
-		
-	while (peakCount < numOfPeaks)
-	{
-		peakCount++;
-
-		coord = findMax();
-		if (!coord.empty() && coord[0] > threshold)
-		{
-			peaks.push_back(coord);
 
-			// suppress the neighborhoods
-			int aTmp = 0;
-			int rTmp = 0;
-			for(int a = coord[1] - hooda; a <= coord[1] + hooda; a++)
-				for (int r = coord[2] - hoodr; r <= coord[2] + hoodr; r++)
-				{
-					// Throw away neighbor coordinates that are out of bounds in
-				    // the rho direction.
-					if (r >= 0 && r < rRange)
-					{
-						// For coordinates that are out of bounds in the theta
-						// direction, we want to consider that H is antisymmetric
-						// along the rho axis for theta = +/ -90 degrees.
-						if (a < 0)
-						{
-							aTmp = a + 180;
-							rTmp = rRange - r;
-						}
-						else if (a >= 180)
-						{
-							aTmp = a - 180;
-							rTmp = rRange - r;
-						}
-						else
-						{
-							aTmp = a;
-							rTmp = r;
-						}
-						
-						rThetaM[aTmp][rTmp] = 0;
-					}
-				}
-		}
+	// generate binary edge image for voting
+	findEdges();
+
+	HOUGH_STAGE_TIME(voteSeconds);
+	voteMatrix(mode, angleWindow);
+}
+
+void HoughTransform::voteMatrix(const VotingMode mode, const double angleWindow)
+{
+	const int hood = votingHood(mode, angleWindow);
+
+	// populate rThetaM matrix using voting
+	if (!pool)
+	{
+		rThetaM.clear();
+		vote(0, edges.size(), rThetaM, hood, 0, 0);
+		return;
 	}
 
+	// every thread votes a slice of the edge list into its own matrix, the first one into rThetaM.
+	// the matrices are then summed up by rows in parallel. integer sums are exact,
+	// so the result is identical to the serial path.
+	const int bands = pool->size();
+	while (partialM.size() < (size_t)bands - 1)
+		partialM.emplace_back(new HoughAccumulator(trig.size, rRange, rThetaM.layout));
+
+	auto voteBand = [&](const int i)
+	{
+		HoughAccumulator &M = i == 0 ? rThetaM : *partialM[i - 1];
+		M.clear();
+		const size_t n = edges.size();
+		vote(n * i / bands, n * (i + 1) / bands, M, hood, 0, 0);
+	};
+	pool->parallelFor(bands, voteBand);
+
+	const int rows = rThetaM.rows();
+	auto reduce = [&](const int i)
+	{
+		const int row0 = rows * i / bands;
+		const int row1 = rows * (i + 1) / bands;
+		for (int k = 0; k < bands - 1; k++)
+			rThetaM.add(*partialM[k], row0, row1);
+	};
+	pool->parallelFor(bands, reduce);
 }
 
-vector<vector<int>> HoughTransform::HoughPixels(const int A, const int R)
+template <typename F>
+void HoughTransform::streamSuppressed(F rowDone)
 {
-	// compute image pixel coordinates belonging the Hough transfrom bin (a, r)
-	vector<vector<int>> pixels;
-	int r;
-	for (int i = 0; i < height; ++i)
-		for (int j = 0; j < width; ++j)
+	// GaussianSobel followed by non maximum suppression row by row. rows of edge amplitudes,
+	// slopes and suppressed amplitudes are kept in rings of 3 rows indexed by row number modulo 3.
+	// rowDone(y) is called once row y is suppressed, when the slopes of rows y - 1 : y + 1 are known.
+	const int w = (int)width;
+	const int h = (int)height;
+	float *amp = streamBuffers;
+	float *slope = streamBuffers + 3 * w;
+	float *suppressed = streamBuffers + 6 * w;
+
+	filterRows<float>(img, w, h, rowBuffers, gaussianRow, gaussianColumn, sobelRow,
+		[&](const int y, const float *const g1[3], const float *const g2[3])
+	{
+		sobelColumn(g1, g2, amp + (y % 3)*w, slope + (y % 3)*w, w);
+
+		// the first row is zero, the others are suppressed once the row below is known
+		if (y == 1)
 		{
-			if (binaryImage[i*width + j])
-			{
-				r = round(j*cos(A / 180.0*pi) + i*sin(A / 180.0*pi));
-				if (r  == R)
-					pixels.push_back({ j, i });
-			}
+			memset(suppressed, 0, w*sizeof(float));
+			rowDone(0);
 		}
-	return pixels;
+		else if (y >= 2)
+		{
+			const float *rows[3] = { amp + ((y - 2) % 3)*w, amp + ((y - 1) % 3)*w, amp + (y % 3)*w };
+			suppressRow(rows, slope + ((y - 1) % 3)*w, suppressed + ((y - 1) % 3)*w, w);
+			rowDone(y - 1);
+		}
+	});
+
+	// the last row is zero
+	memset(suppressed + ((h - 1) % 3)*w, 0, w*sizeof(float));
+	rowDone(h - 1);
 }
 
-void HoughTransform::HoughLines(const int numOfLines, const int fillGap, const int minLength)
+void HoughTransform::addRowHistogram(const float *row, const int y)
 {
-	// search for line segments corresponding to peaks in the Hough transform matrix.
-	// if the gap between colinear segments are smaller than fillGap, connect them.
-	// if the merged line is shorter than minLength, discard it.
-	// lines are stored in vectors by the coordinates of starting and ending points
-	// as [x1, y1, x2, y2]
+	// the histogram of addHistogram, one row at a time
+	for (int x = 0; x < (int)width; x++)
+		if (!roiMask || roiMask->test(x, y))
+			hist[(unsigned char)(row[x])]++;
+}
 
-	HoughPeaks(numOfLines);
-	vector<vector<int>> pixels;
-	for (auto const &p : peaks)
+void HoughTransform::StreamMatrix(const VotingMode mode, const double angleWindow)
+{
+	// the image flows row by row through filtering, suppression, thresholding and voting,
+	// so only a few rows of every stage are kept. a row is thresholded once the suppressed
+	// rows around it are known, with the rule that weak pixels are kept next to a strong one.
+	const int w = (int)width;
+	const int h = (int)height;
+	const float *slope = streamBuffers + 3 * w;
+	const float *suppressed = streamBuffers + 6 * w;
+
+	// thresholds of a first pass over the image, unless those of the previous frame are used
+	if (!previousThresholds || !haveThresholds)
 	{
-		// compute image pixel coordinates belonging the Hough transfrom bin (a, r)
-		pixels = HoughPixels(p[1] - 90, p[2] - (rRange - 1) / 2);
-		if (pixels.empty())
-			break;
+		for (int i = 0; i < 256; i++)
+			hist[i] = 0;
+		streamSuppressed([&](const int y)
+		{
+			addRowHistogram(suppressed + (y % 3)*w, y);
+		});
+		edgeThresholds(hist, streamHigh, streamLow);
+	}
+	const unsigned char high = streamHigh;
+	const unsigned char low = streamLow;
+
+	for (int i = 0; i < 256; i++)
+		hist[i] = 0;
+	edges.clear();
+	rThetaM.clear();
+	const int hood = votingHood(mode, angleWindow);
+
+	streamSuppressed([&](const int y)
+	{
+		const float *row = suppressed + (y % 3)*w;
+		addRowHistogram(row, y);
 
-		int gap, length;
-		
-		// store the temporary starting and ending points
-		auto q1 = pixels.begin();
-		auto q2 = pixels.begin();
-		
-		// find gaps between line segments that are larger than threshold
-		for (auto it = pixels.begin(); it != pixels.end()-1; it++)
+		const int t = y - 1;
+		if (t < 1 || t >= h - 1)
+			return;
+
+		const float *up = suppressed + ((t - 1) % 3)*w;
+		const float *mid = suppressed + (t % 3)*w;
+		const float *down = row;
+		const size_t e0 = edges.size();
+		for (int x = 1; x < w - 1; x++)
 		{
-			gap = ((*it)[0] - (*(it + 1))[0]) * ((*it)[0] - (*(it + 1))[0])
-				+ ((*it)[1] - (*(it + 1))[1]) * ((*it)[1] - (*(it + 1))[1]);
-			if (gap > fillGap*fillGap)
+			// weak pixels are kept if one of the 8-connected neighborhood pixels is strong
+			if (mid[x] > high || (mid[x] > low &&
+				(mid[x - 1] > high || mid[x + 1] > high || up[x - 1] > high || up[x] > high ||
+				up[x + 1] > high || down[x - 1] > high || down[x] > high || down[x + 1] > high)))
 			{
-				q2 = it;
-				length = ((*q1)[0] - (*q2)[0])*((*q1)[0] - (*q2)[0]) + ((*q1)[1] - (*q2)[1])*((*q1)[1] - (*q2)[1]);
-				if (length >= minLength*minLength)
-					lines.push_back({ (*q1)[0], (*q1)[1], (*q2)[0], (*q2)[1] });
-				// reset the starting and ending points
-				q1 = it + 1;
-				q2 = it + 1;
+				// only pixels of the region of interest are edges
+				if (!roiMask || roiMask->test(x, t))
+					edges.push_back(x, t);
 			}
 		}
-		// if no large gap found, push the line
-		if (q1 == q2)
-		{
-			q2 = pixels.end()-1;
-			length = ((*q1)[0] - (*q2)[0])*((*q1)[0] - (*q2)[0]) + ((*q1)[1] - (*q2)[1])*((*q1)[1] - (*q2)[1]);
-			if (length >= minLength*minLength)
-				lines.push_back({ (*q1)[0], (*q1)[1], (*q2)[0], (*q2)[1] });
-		}
 
+		const float *slopeRow = slope + (t % 3)*w;
+		vote(e0, edges.size(), rThetaM, hood, 0, 0, [&](const size_t e) { return slopeBin(slopeRow[edges.x[e]]); });
+	});
+
+	// the thresholds for the next frame
+	edgeThresholds(hist, streamHigh, streamLow);
+	haveThresholds = true;
+}
+
+void HoughTransform::HoughPeaks(const int numOfPeaks, const int hooda, const int hoodr)
+{	
+	// find peaks of Hough Transfrom matrix
+	// suppress the neighborhoods. neighborhoods window size equals (hooda*2+1)x(hoodr*2+1)
+	// modified from MATLAB
+
+	rThetaM.findPeaks(numOfPeaks, hooda, hoodr, peaks, pool.get());
+}
+
+
+void HoughTransform::HoughLines(const int numOfLines, const int fillGap, const int minLength,
+	const VotingMode mode, const double angleWindow)
+{
+	// search for line segments corresponding to peaks in the Hough transform matrix.
+	// lines are stored in vectors by the coordinates of starting and ending points
+	// as [x1, y1, x2, y2]
+
+	HOUGH_STAT(stats.clear());
+	HOUGH_STAGE_TIME(totalSeconds);
+
+	reset();
+	HoughMatrix(mode, angleWindow);
+	{
+		HOUGH_STAGE_TIME(peakSeconds);
+		HoughPeaks(numOfLines);
+	}
+	{
+		HOUGH_STAGE_TIME(segmentSeconds);
+		segments.index(edges, peaks, trig, (rRange - 1) / 2);
+		segments.extract(edges, fillGap, minLength, region.x, region.y, lines);
 	}
+
+	HOUGH_STAT(
+		const int hood = votingHood(mode, angleWindow);
+		stats.edges = edges.size();
+		stats.votes = edges.size() * (hood < 0 ? trig.size : 2 * hood + 1);
+		stats.accumulatorMax = rThetaM.max();
+		stats.peaks = peaks.size();
+		for (int k = 0; k < (int)peaks.size(); k++)
+			stats.peakPixels.push_back(segments.pixelCount(k));
+	)
 }
 
 
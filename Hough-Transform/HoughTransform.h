@@ -1,52 +1,212 @@
 #ifndef _HOUGHTRANSFORM_H
 #define _HOUGHTRANSFORM_H
 
+#include <array>
+#include <memory>
 #include <vector>
 
+#include "Arena.h"
+#include "BitImage.h"
+#include "EdgeList.h"
+#include "HoughAccumulator.h"
+#include "HoughSegments.h"
+#include "HoughStats.h"
+#include "Image.h"
+#include "Roi.h"
+#include "TrigTable.h"
+
+class WorkerPool;
+
+using std::array;
 using std::vector;
 
 class HoughTransform 
 {
+	friend class HoughBenchmark;	// times the private stages
+
 public:
-	HoughTransform(size_t w, size_t h);
+	// thetaResolution is the angle between two theta bins in degrees
+	// layout selects the memory order of the r-theta voting matrix
+	HoughTransform(size_t w, size_t h, const double thetaResolution = 1.0,
+		const HoughAccumulator::Layout layout = HoughAccumulator::ThetaMajor);
+	// process only roi of frames of frameWidth x frameHeight pixels: only the region and the
+	// margin the filters need are filtered, only edges inside the region vote, and rRange fits
+	// the region. lines are still given in frame coordinates. frames are passed to process.
+	// throws invalid_argument if the bounds of roi have no pixel inside the frame.
+	HoughTransform(size_t frameWidth, size_t frameHeight, const Roi &roi, const double thetaResolution = 1.0,
+		const HoughAccumulator::Layout layout = HoughAccumulator::ThetaMajor);
 	~HoughTransform();
 		
-	const size_t width;
+	// pixels around a part of an image the filters need to give the same result there as on
+	// the whole image: 2 for the Gaussian, 1 for Sobel and 1 for non maximum suppression
+	static const int filterMargin = 4;
+
+	// half size in theta and rho bins of the neighbourhood every peak suppresses,
+	// the same for HoughLines and the transforms built on its stages
+	static const int peakThetaHood = 2;
+	static const int peakRhoHood = 5;
+
+	const size_t width;		// size of the processed part of the frame
 	const size_t height;
-	unsigned char *img;	
+	ImageView<const unsigned char> img;	// processed part of the frame, rows may be padded or stored bottom-up
+
+	// number of threads used for voting, 0 for one per hardware thread.
+	// the default of 1 runs everything on the calling thread.
+	void setNumThreads(int n);
+
+	// ReferenceFilters: GaussianFilter() and SobelEdge() on full image planes
+	// FusedFilters: both filters in one pass over the image with a few rolling rows,
+	// giving identical results with much less memory traffic
+	// IntegerFilters: fixed-point version of FusedFilters with 16-bit gradients and
+	// 8-bit suppressed amplitudes, close to but not identical with the float filters
+	// StreamingFilters: rows flow through the FusedFilters, suppression, thresholding and voting
+	// keeping a few rows of every stage, so the working set does not grow with the image height.
+	// weak pixels are only kept next to strong ones, see setStreamingThresholds for the
+	// thresholds. the stage methods below need one of the other front ends.
+	enum FrontEnd { ReferenceFilters, FusedFilters, IntegerFilters, StreamingFilters };
+	void setFrontEnd(const FrontEnd f);
+
+	// thresholds of StreamingFilters. false, the default, runs a first pass over the image
+	// for them. true uses those of the previous frame, which saves the first pass on video.
+	void setStreamingThresholds(const bool previousFrame);
+
+	// bytes of the working planes handed out so far plus the voting matrices. planes are
+	// taken from one arena reserved by the constructor, and only for the front ends used.
+	size_t memoryUsed() const;
+
+	// number of edge pixels found by the last call of HoughLines
+	size_t edgeCount() const { return edges.size(); }
+
+	// time and counters of the stages of the last call of HoughLines, all zero
+	// unless HOUGH_STATS is defined
+	const HoughStats &stageStats() const { return stats; }
+
+	// FullVoting: every edge pixel votes for all theta bins
+	// GradientVoting: every edge pixel only votes for theta bins within +/- angleWindow
+	// degrees of its gradient direction
+	enum VotingMode { FullVoting, GradientVoting };
 	
 	// find lines from peaks of Hough transfrom matrix
-	void HoughLines(const int numOfLines = 1, const int fillGap = 20, const int minLength = 40);
+	void HoughLines(const int numOfLines = 1, const int fillGap = 20, const int minLength = 40,
+		const VotingMode mode = FullVoting, const double angleWindow = 10);
+
+	// clear the results of the last image. all buffers are kept for the next one.
+	void reset();
 
-	// lines are stored in vectors by the coordinates of starting and ending points
+	// find lines in frame, an image of width x height pixels, see HoughLines. the pixels are
+	// read in place, so any view of them works without copying.
+	// the same transform can process any number of frames. buffers are allocated by the
+	// constructor, setNumThreads and setFrontEnd, or grow during the first frames,
+	// so the following frames do not allocate memory.
+	const vector<array<int, 4>> &process(const ImageView<const unsigned char> &frame, const int numOfLines = 1,
+		const int fillGap = 20, const int minLength = 40, const VotingMode mode = FullVoting, const double angleWindow = 10);
+	// frame given as width * height contiguous pixels
+	const vector<array<int, 4>> &process(const unsigned char *frame, const int numOfLines = 1, const int fillGap = 20,
+		const int minLength = 40, const VotingMode mode = FullVoting, const double angleWindow = 10);
+
+	// lines are stored by the coordinates of starting and ending points
 	// as [x1, y1, x2, y2]
-	vector<vector<int>> lines;	
+	vector<array<int, 4>> lines;
+
+	// stages of HoughLines, for pipelines running them on parts of an image such as TiledHoughTransform.
+	// run the front end on img up to non maximum suppression. StreamingFilters has no planes
+	// to leave the suppressed amplitudes in, so it throws invalid_argument
+	void filterEdges();
+	// filterEdges, then thresholds from the whole image and thresholdEdges on all of it
+	void findEdges();
+	// add the histogram of suppressed edge amplitudes of the pixels in part to h
+	void addHistogram(unsigned int h[256], const Rect &part) const;
+	// hysteresis thresholds of a histogram of suppressed edge amplitudes
+	static void edgeThresholds(const unsigned int hist[256], unsigned char &high, unsigned char &low);
+	// threshold the suppressed edge amplitudes by hysteresis into the edge list,
+	// only pixels inside part can be edges
+	void thresholdEdges(const unsigned char high, const unsigned char low, const Rect &part);
+	void keepEdges(const Rect &part);	// remove the edges outside part
+	const EdgeList &edgeList() const { return edges; }
+	const HoughAccumulator &votingMatrix() const { return rThetaM; }	// votes of the last image
+	// vote the edges into M, pixel (x, y) of img being pixel (x0 + x, y0 + y) of the image of M
+	void voteEdges(HoughAccumulator &M, const int x0, const int y0, const VotingMode mode = FullVoting,
+		const double angleWindow = 10);	
 
 private:
+	HoughTransform(const Rect &r, size_t frameWidth, size_t frameHeight, const double thetaResolution,
+		const HoughAccumulator::Layout layout);
+
+	const Rect region;		// processed part of the frame
+	const size_t frameWidth;
+	const size_t frameHeight;
+
+	Arena arena;			// memory of all image planes
+
 	float *filteredImg;		// Gaussian filtered image
 	float *edgeAmp;			// amplitute of soble edge
-	int *edgeAngle;			// angle of soble edge
+	float *edgeSlope;		// slope Gy / Gx of soble gradient
+	float *rowBuffers;		// rolling rows of GaussianSobel
 	float *imgSuppressed;	// non maximum suppressed edge image
-	bool *binaryImage;		// binary image
+	float *referenceScratch;	// temporary planes of GaussianFilter and SobelEdge
+	float *streamBuffers;	// rolling rows of StreamMatrix
+
+	// planes of the fixed-point front end, amplitudes are scaled by 16
+	short *edgeAmpInt;
+	short *GxInt;
+	short *GyInt;
+	unsigned char *imgSuppressedInt;
+	short *rowBuffersInt;
+
+	BitImage binaryImage;	// binary image
+	BitImage weakImage;		// pixels above the low threshold
+	std::unique_ptr<BitImage> roiMask;	// pixels of the region of interest, null without one
+	EdgeList edges;			// coordinates of the pixels set in binaryImage
+	vector<vector<int>> bandWorklists;	// pixels to grow edges from, per band of rows
 
 	unsigned int hist[256];				// histogram of imgSuppressed
 
+	const TrigTable trig;	// cos/sin of every theta bin, shared by voting and back-projection
+
 	int rRange;				// maximum r of r-theta matrix
-	vector<vector<int>> rThetaM; // 2D array to store the r-theta voting matrix
-	vector<vector<int>> peaks; // coordinates of peaks of rThetaM
+	HoughAccumulator rThetaM; // 2D array to store the r-theta voting matrix
+	vector<HoughPeak> peaks; // coordinates of peaks of rThetaM
+
+	HoughSegments segments;	// edge pixels and line segments of every peak
+
+	std::unique_ptr<WorkerPool> pool;	// threads for parallel voting, null when serial
+	vector<std::unique_ptr<HoughAccumulator>> partialM; // per-thread voting matrices
+
+	FrontEnd frontEnd;
+	HoughStats stats;
+
+	// thresholds of StreamingFilters
+	bool previousThresholds;
+	bool haveThresholds;
+	unsigned char streamHigh;
+	unsigned char streamLow;
 
 	void GaussianFilter();
 	void SobelEdge();
+	void GaussianSobel();	// GaussianFilter and SobelEdge fused into one pass
+	void GaussianSobelInt();
 	void NonMaxSuppression();
-	void histogram();
-	unsigned char otsu();
+	void NonMaxSuppressionInt();
+	template <typename T> void addHistogram(const T *suppressed, unsigned int h[256], const Rect &part) const;
+	static unsigned char otsu(const unsigned int hist[256]);
 	unsigned char percentile(const double p);
-	void threshold();	// convert the image to binary
+	template <typename T> void threshold(const T *suppressed, const unsigned char high,
+		const unsigned char low, const Rect &part);	// convert the image to binary and collect the edge list
+	void hysteresis(vector<int> &worklist, const size_t y0, const size_t y1);	// grow edges from the pixels in worklist through weak pixels
 
-	void HoughMatrix(); // compute hough transform matrix	
-	vector<int> findMax(); // find coordinates of maximum of hough transform matrix						   
-	void HoughPeaks(const int numOfPeaks = 1, const int hooda = 2, const int hoodr = 5); // find coordinates of peaks of Hough transform matrix
-	vector<vector<int>> HoughPixels(const int a, const int r);
+	int slopeBin(const double slope) const; // theta bin of a gradient direction given by its slope
+	int gradientBin(const size_t index) const; // theta bin of the gradient direction at pixel index
+	int votingHood(const VotingMode mode, const double angleWindow) const;	// theta bins voted on each side of the gradient, -1 for all
+	void vote(const size_t e0, const size_t e1, HoughAccumulator &M, const int hood,
+		const int x0, const int y0); // vote edge pixels e0 : e1 - 1
+	template <typename Bin> void vote(const size_t e0, const size_t e1, HoughAccumulator &M, const int hood,
+		const int x0, const int y0, Bin bin);
+	template <typename F> void streamSuppressed(F rowDone);
+	void addRowHistogram(const float *row, const int y);	// add suppressed row y to hist
+	void StreamMatrix(const VotingMode mode, const double angleWindow); // HoughMatrix of StreamingFilters
+	void voteMatrix(const VotingMode mode, const double angleWindow);	// vote the edge list into rThetaM, by all threads of the pool
+	void HoughMatrix(const VotingMode mode = FullVoting, const double angleWindow = 10); // compute hough transform matrix	
+	void HoughPeaks(const int numOfPeaks = 1, const int hooda = peakThetaHood, const int hoodr = peakRhoHood); // find coordinates of peaks of Hough transform matrix
 };
 
 
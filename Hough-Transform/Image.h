@@ -1,76 +1,147 @@
 #ifndef IMAGE_H
 #define IMAGE_H
 
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "Aligned.h"
+
+// non-owning view of an image: pixel (x, y) is data[y * stride + x]. the stride is given
+// in pixels and may be larger than the width, or negative for images stored bottom-up.
+template <typename T>
+class ImageView {
+public:
+	T *data;
+	size_t width;
+	size_t height;
+	std::ptrdiff_t stride;
+
+	ImageView() : data{ nullptr }, width{ 0 }, height{ 0 }, stride{ 0 } {}
+	ImageView(T *data, size_t width, size_t height)
+		: data{ data }, width{ width }, height{ height }, stride{ (std::ptrdiff_t)width } {}
+	ImageView(T *data, size_t width, size_t height, std::ptrdiff_t stride)
+		: data{ data }, width{ width }, height{ height }, stride{ stride } {}
+
+	// a view of T converts to a view of const T
+	template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+	ImageView(const ImageView<U> &view)
+		: data{ view.data }, width{ view.width }, height{ view.height }, stride{ view.stride } {}
+
+	T *row(size_t y) const { return data + (std::ptrdiff_t)y * stride; }
+	T &operator()(size_t x, size_t y) const { return row(y)[x]; }
+
+	// rows are contiguous, so the view can be read as one width * height array
+	bool isContiguous() const { return stride == (std::ptrdiff_t)width; }
+
+	// the w x h region starting at pixel (x, y), sharing the pixels of this view
+	ImageView sub(size_t x, size_t y, size_t w, size_t h) const
+	{
+		return ImageView(row(y) + x, w, h, stride);
+	}
+};
+
+// image owning its pixels. rows start on cache lines, so stride may be larger than width.
 template <typename T>
 class Image {
 public:
 	size_t width;
 	size_t height;
+	size_t stride;	// pixels between the starts of two rows
 	T *pixels;
 
 	Image(size_t width, size_t height);
 	Image(const Image& image) = delete;
 	Image& operator=(const Image&) = delete;
+	Image(Image&& image) noexcept;
+	Image& operator=(Image&& image) noexcept;
 
 	~Image();
 
-	std::size_t GetBytesPerPixel();
-	std::size_t GetSizeInBytes();
+	std::size_t GetBytesPerPixel() const;
+	std::size_t GetSizeInBytes() const;
 
-	bool operator==(const Image& rhs) const;
+	ImageView<T> view() { return ImageView<T>(pixels, width, height, stride); }
+	ImageView<const T> view() const { return ImageView<const T>(pixels, width, height, stride); }
 
-protected:
-	Image(size_t width, size_t height, T *pixels);
+	bool operator==(const Image& rhs) const;
 };
 
 template <typename T>
 Image<T>::Image(size_t width, size_t height)
-	: width{ width }, height{ height }, pixels{ new T[width*height] } 
+	: width{ width }, height{ height }, stride{ roundUp(width * sizeof(T), CACHE_LINE) / sizeof(T) }, pixels{ nullptr }
+{
+	const size_t bytes = stride * height * sizeof(T);
+	pixels = (T *)alignedAlloc(bytes > 0 ? bytes : 1);
+	if (pixels == nullptr)
+		throw std::bad_alloc();
+}
+
+template <typename T>
+Image<T>::Image(Image&& image) noexcept
+	: width{ image.width }, height{ image.height }, stride{ image.stride }, pixels{ image.pixels }
 {
+	image.width = 0;
+	image.height = 0;
+	image.pixels = nullptr;
 }
 
 template <typename T>
-Image<T>::~Image() 
+Image<T>& Image<T>::operator=(Image&& image) noexcept
 {
-	// delete[] pixels;
+	if (this != &image)
+	{
+		alignedFree(pixels);
+		width = image.width;
+		height = image.height;
+		stride = image.stride;
+		pixels = image.pixels;
+		image.width = 0;
+		image.height = 0;
+		image.pixels = nullptr;
+	}
+	return *this;
 }
 
 template <typename T>
-size_t Image<T>::GetBytesPerPixel() 
+Image<T>::~Image()
+{
+	alignedFree(pixels);
+}
+
+template <typename T>
+size_t Image<T>::GetBytesPerPixel() const
 {
 	return sizeof(T);
 }
 
 template <typename T>
-size_t Image<T>::GetSizeInBytes() 
+size_t Image<T>::GetSizeInBytes() const
 {
 	return this->width * this->height * this->GetBytesPerPixel();
 }
 
 template <typename T>
-bool Image<T>::operator==(const Image& rhs) const 
+bool Image<T>::operator==(const Image& rhs) const
 {
-	if (width == rhs.width && height == rhs.height) 
+	if (width == rhs.width && height == rhs.height)
 	{
-		for (auto i = 0; i < width*height; ++i) 
+		for (size_t y = 0; y < height; ++y)
 		{
-			if (pixels[i] != rhs.pixels[i]) 
+			for (size_t x = 0; x < width; ++x)
 			{
-				return false;
+				if (pixels[y*stride + x] != rhs.pixels[y*rhs.stride + x])
+				{
+					return false;
+				}
 			}
 		}
 		return true;
 	}
-	else 
+	else
 	{
 		return false;
 	}
 }
 
-template <typename T>
-Image<T>::Image(size_t width, size_t height, T *pixels)
-	: width{ width }, height{ height }, pixels{ pixels } 
-{
-}
-
 #endif
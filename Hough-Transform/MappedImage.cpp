@@ -0,0 +1,209 @@
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "MappedImage.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define HOUGH_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// little endian integers of the BMP headers
+static unsigned readU16(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned readU32(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24);
+}
+
+unique_ptr<MappedImage> MappedImage::open(const string &path)
+{
+	unique_ptr<MappedImage> image(new MappedImage);
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw runtime_error("can not open " + path);
+	image->file = file;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size))
+		throw runtime_error("can not read " + path);
+	image->size = (size_t)size.QuadPart;
+	if (image->size == 0)
+		return nullptr;
+	image->mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (image->mapping == nullptr)
+		throw runtime_error("can not map " + path);
+	image->data = (const unsigned char *)MapViewOfFile(image->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (image->data == nullptr)
+		throw runtime_error("can not map " + path);
+#elif defined(HOUGH_MMAP)
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw runtime_error("can not open " + path);
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		throw runtime_error("can not read " + path);
+	}
+	image->size = (size_t)st.st_size;
+	if (image->size == 0)
+	{
+		close(fd);
+		return nullptr;
+	}
+	void *p = mmap(nullptr, image->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		throw runtime_error("can not map " + path);
+	image->data = (const unsigned char *)p;
+#ifdef MADV_WILLNEED
+	// start reading the pages in, so they are there when the pixels are
+	madvise(p, image->size, MADV_WILLNEED);
+#endif
+#else
+	FILE *f = fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		throw runtime_error("can not open " + path);
+	unsigned char chunk[65536];
+	size_t n;
+	while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+		image->buffer.insert(image->buffer.end(), chunk, chunk + n);
+	fclose(f);
+	image->data = image->buffer.data();
+	image->size = image->buffer.size();
+#endif
+
+	if (image->parsePgm(path) || image->parseBmp(path))
+		return image;
+	return nullptr;
+}
+
+MappedImage::~MappedImage()
+{
+#if defined(_WIN32)
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != nullptr)
+		CloseHandle(file);
+#elif defined(HOUGH_MMAP)
+	if (data != nullptr)
+		munmap((void *)data, size);
+#endif
+}
+
+bool MappedImage::parsePgm(const string &path)
+{
+	// "P5", width, height and maxval separated by whitespace and comments, then one
+	// whitespace character and the rows of width bytes from the top
+	if (size < 2 || data[0] != 'P' || data[1] != '5')
+		return false;
+
+	size_t i = 2;
+	unsigned long fields[3];
+	for (int k = 0; k < 3; k++)
+	{
+		while (i < size && (isspace(data[i]) || data[i] == '#'))
+		{
+			if (data[i] == '#')
+				while (i < size && data[i] != '\n')
+					i++;
+			else
+				i++;
+		}
+		if (i == size || !isdigit(data[i]))
+			throw runtime_error("bad PGM header in " + path);
+		fields[k] = 0;
+		while (i < size && isdigit(data[i]) && fields[k] < 1000000)
+			fields[k] = fields[k] * 10 + (data[i++] - '0');
+	}
+	// 16-bit gray is left to other readers
+	if (fields[2] == 0 || fields[2] > 255)
+		return false;
+	if (i == size || !isspace(data[i]))
+		throw runtime_error("bad PGM header in " + path);
+	i++;
+
+	const size_t w = fields[0];
+	const size_t h = fields[1];
+	if (w == 0 || h == 0 || size - i < w * h)
+		throw runtime_error("PGM file " + path + " is cut short");
+	if (fields[2] == 255)
+	{
+		pixels = ImageView<const unsigned char>(data + i, w, h);
+		return true;
+	}
+
+	// stretch 0 : maxval to 0 : 255, values above maxval are invalid and saturate
+	const unsigned maxval = (unsigned)fields[2];
+	unsigned char scale[256];
+	for (unsigned v = 0; v < 256; v++)
+		scale[v] = (unsigned char)(v >= maxval ? 255 : (v * 255 + maxval / 2) / maxval);
+	rescaled.resize(w * h);
+	for (size_t k = 0; k < w * h; k++)
+		rescaled[k] = scale[data[i + k]];
+	pixels = ImageView<const unsigned char>(rescaled.data(), w, h);
+	return true;
+}
+
+bool MappedImage::parseBmp(const string &path)
+{
+	// file header of 14 bytes and an info header of at least 40, then the palette
+	if (size < 2 || data[0] != 'B' || data[1] != 'M')
+		return false;
+	if (size < 54)
+		throw runtime_error("BMP file " + path + " is cut short");
+
+	const size_t offset = readU32(data + 10);
+	const size_t infoSize = readU32(data + 14);
+	const int width = (int)readU32(data + 18);
+	const int height = (int)readU32(data + 22);
+	const unsigned bitCount = readU16(data + 28);
+	const unsigned compression = readU32(data + 30);
+	unsigned colours = readU32(data + 46);
+	if (infoSize < 40 || bitCount != 8 || compression != 0 || width <= 0 || height == 0)
+		return false;
+	if (colours == 0 || colours > 256)
+		colours = 256;
+
+	// every palette entry, stored as blue, green, red and a reserved byte, must be its own index.
+	// only the colours entries in the file are checked: pixels with a larger index have no
+	// colour in the file and are read as their index.
+	const size_t palette = 14 + infoSize;
+	if (palette + 4 * colours > size)
+		throw runtime_error("BMP file " + path + " is cut short");
+	for (unsigned c = 0; c < colours; c++)
+	{
+		const unsigned char *entry = data + palette + 4 * c;
+		if (entry[0] != c || entry[1] != c || entry[2] != c)
+			return false;
+	}
+
+	// rows are padded to 4 bytes, stored from the bottom unless the height is negative
+	const size_t w = width;
+	const size_t h = height > 0 ? height : -(ptrdiff_t)height;
+	const ptrdiff_t rowBytes = (ptrdiff_t)((w + 3) / 4 * 4);
+	if (offset > size || (size - offset) / rowBytes < h)
+		throw runtime_error("BMP file " + path + " is cut short");
+	if (height > 0)
+		pixels = ImageView<const unsigned char>(data + offset + (h - 1) * rowBytes, w, h, -rowBytes);
+	else
+		pixels = ImageView<const unsigned char>(data + offset, w, h, rowBytes);
+	return true;
+}
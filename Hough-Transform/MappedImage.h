@@ -0,0 +1,45 @@
+#ifndef _MAPPEDIMAGE_H
+#define _MAPPEDIMAGE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Image.h"
+
+// 8-bit gray PGM (P5) or BMP file mapped into memory. the pixels are read in place through
+// a view of the mapping, BMP files stored bottom-up get a negative stride. PGM files with a
+// maxval below 255 are the exception: they are rescaled to 0 : 255 into a copy, so the
+// thresholds see the same range as for other images. BMP files must be uncompressed,
+// 8 bits per pixel with a gray palette mapping every index to itself.
+class MappedImage
+{
+public:
+	// map the file at path. returns null for other formats, so another reader can be tried.
+	// throws std::runtime_error if the file can not be read or is cut short.
+	static std::unique_ptr<MappedImage> open(const std::string &path);
+
+	MappedImage(const MappedImage&) = delete;
+	MappedImage& operator=(const MappedImage&) = delete;
+	~MappedImage();
+
+	const ImageView<const unsigned char> &view() const { return pixels; }
+
+private:
+	MappedImage() : data(nullptr), size(0), file(nullptr), mapping(nullptr) {}
+
+	// set pixels from the header, false if the file is not of that format
+	bool parsePgm(const std::string &path);
+	bool parseBmp(const std::string &path);
+
+	const unsigned char *data;	// the whole file
+	size_t size;
+	void *file;			// handles of the mapping on Windows
+	void *mapping;
+	std::vector<unsigned char> buffer;	// the file where it can not be mapped
+	std::vector<unsigned char> rescaled;	// pixels of PGM files with a maxval below 255
+
+	ImageView<const unsigned char> pixels;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Roi.h"
+
+using namespace std;
+
+Roi::Roi(const Rect &rect) : box(rect)
+{
+}
+
+Roi::Roi(const vector<array<int, 2>> &polygon) : box{ 0, 0, 0, 0 }, corners(polygon)
+{
+	if (corners.empty())
+		return;
+
+	int x0 = corners[0][0], x1 = x0;
+	int y0 = corners[0][1], y1 = y0;
+	for (const auto &p : corners)
+	{
+		x0 = min(x0, p[0]);
+		x1 = max(x1, p[0]);
+		y0 = min(y0, p[1]);
+		y1 = max(y1, p[1]);
+	}
+	box = { x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+}
+
+void Roi::rasterize(BitImage &mask, const int x0, const int y0) const
+{
+	const int w = (int)mask.width;
+	const int h = (int)mask.height;
+
+	if (isRect())
+	{
+		for (int y = max(box.y - y0, 0); y < min(box.y + box.height - y0, h); y++)
+			for (int x = max(box.x - x0, 0); x < min(box.x + box.width - x0, w); x++)
+				mask.set(x, y);
+		return;
+	}
+
+	// scan the centre line of every row, the polygon covers the pixels between
+	// every other pair of crossings with its edges
+	const int n = (int)corners.size();
+	vector<double> crossings;
+	for (int y = 0; y < h; y++)
+	{
+		const double yc = y0 + y + 0.5;
+		crossings.clear();
+		for (int i = 0; i < n; i++)
+		{
+			const auto &p = corners[i];
+			const auto &q = corners[(i + 1) % n];
+			if ((p[1] <= yc) != (q[1] <= yc))
+				crossings.push_back(p[0] + (yc - p[1]) * (q[0] - p[0]) / (q[1] - p[1]));
+		}
+		sort(crossings.begin(), crossings.end());
+
+		for (size_t i = 0; i + 1 < crossings.size(); i += 2)
+		{
+			// pixels with their centre x + 0.5 in [crossings[i], crossings[i + 1])
+			const int xa = max((int)ceil(crossings[i] - 0.5) - x0, 0);
+			const int xb = min((int)ceil(crossings[i + 1] - 0.5) - x0, w);
+			for (int x = xa; x < xb; x++)
+				mask.set(x, y);
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef _ROI_H
+#define _ROI_H
+
+#include <array>
+#include <vector>
+
+#include "BitImage.h"
+
+using std::array;
+using std::vector;
+
+// rectangle of the pixels x : x + width - 1, y : y + height - 1
+struct Rect
+{
+	int x;
+	int y;
+	int width;
+	int height;
+};
+
+// region of interest of a frame, a rectangle or a polygon
+class Roi
+{
+public:
+	Roi(const Rect &rect);
+	// polygon given by its corners [x, y] in order. a pixel is inside if its centre is,
+	// by the even-odd rule, so the polygon may be concave or self-intersecting.
+	Roi(const vector<array<int, 2>> &polygon);
+
+	const Rect &bounds() const { return box; }	// smallest rectangle containing the region
+	bool isRect() const { return corners.empty(); }
+
+	// set the pixels of mask inside the region, pixel (x, y) of mask being pixel (x0 + x, y0 + y) of the frame
+	void rasterize(BitImage &mask, const int x0, const int y0) const;
+
+private:
+	Rect box;
+	vector<array<int, 2>> corners;
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef _SPSCQUEUE_H
+#define _SPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "Aligned.h"
+
+using std::vector;
+
+// bounded lock-free queue between one producer thread and one consumer thread.
+// head is only written by the consumer and tail only by the producer, each on its own cache line.
+template <typename T>
+class SpscQueue
+{
+public:
+	SpscQueue(const size_t capacity) : items(capacity), head(0), tail(0) {}
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	size_t capacity() const { return items.size(); }
+	// only a snapshot while the threads run. head is read first, so it is never past the tail read
+	// after it, and pushes and pops between the two reads are clamped to the capacity.
+	size_t size() const
+	{
+		const size_t h = head.load(std::memory_order_acquire);
+		const size_t t = tail.load(std::memory_order_acquire);
+		return std::min(t - h, items.size());
+	}
+
+	// producer: append item, false if the queue is full
+	bool push(const T &item)
+	{
+		const size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == items.size())
+			return false;
+		items[t % items.size()] = item;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer: take the oldest item, false if the queue is empty
+	bool pop(T &item)
+	{
+		const size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+		item = items[h % items.size()];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	vector<T> items;
+	alignas(CACHE_LINE) std::atomic<size_t> head;	// items popped so far
+	alignas(CACHE_LINE) std::atomic<size_t> tail;	// items pushed so far
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "TiledHoughTransform.h"
+
+using namespace std;
+
+TiledHoughTransform::TiledHoughTransform(size_t w, size_t h, const size_t tileSize, const double thetaResolution,
+	const HoughAccumulator::Layout layout) :
+	width(w), height(h), tileSize((int)tileSize),
+	tile(min(tileSize + 2 * (HoughTransform::filterMargin + hysteresisMargin), w),
+		min(tileSize + 2 * (HoughTransform::filterMargin + hysteresisMargin), h), thetaResolution, layout),
+	trig(thetaResolution), rThetaM(trig.size, 2 * (int)ceil(sqrt(w*w + h*h)) + 1, layout), numOfEdges(0)
+{
+}
+
+void TiledHoughTransform::setFrontEnd(const HoughTransform::FrontEnd f)
+{
+	if (f == HoughTransform::StreamingFilters)
+		throw invalid_argument("TiledHoughTransform::setFrontEnd: StreamingFilters can not be split into tiles");
+	tile.setFrontEnd(f);
+}
+
+size_t TiledHoughTransform::memoryUsed() const
+{
+	return tile.memoryUsed() + rThetaM.rows() * rThetaM.stride() * sizeof(int)
+		+ peakPixels.capacity() * sizeof(size_t) + 2 * peakEdges.x.capacity() * sizeof(int);
+}
+
+template <typename F>
+void TiledHoughTransform::forEachTile(const ImageView<const unsigned char> &image, F f)
+{
+	// tiles own tileSize x tileSize pixels of the image. edges are searched up to hysteresisMargin
+	// pixels around them, and the tile transform is larger by the filter margin on top of that.
+	// tiles at the image border are moved inwards, so every tile fills the whole transform and
+	// the margins reach the border or are wide enough.
+	const int m = HoughTransform::filterMargin + hysteresisMargin;
+	const int w = (int)width;
+	const int h = (int)height;
+	const int tw = (int)tile.width;
+	const int th = (int)tile.height;
+
+	for (int cy = 0; cy < h; cy += tileSize)
+		for (int cx = 0; cx < w; cx += tileSize)
+		{
+			const int x0 = max(min(cx - m, w - tw), 0);
+			const int y0 = max(min(cy - m, h - th), 0);
+			tile.img = image.sub(x0, y0, tw, th);
+			tile.filterEdges();
+
+			const int cw = min(tileSize, w - cx);
+			const int ch = min(tileSize, h - cy);
+			const int ex0 = max(cx - hysteresisMargin, 0);
+			const int ey0 = max(cy - hysteresisMargin, 0);
+			const int ex1 = min(cx + cw + hysteresisMargin, w);
+			const int ey1 = min(cy + ch + hysteresisMargin, h);
+			f(Rect{ cx - x0, cy - y0, cw, ch }, Rect{ ex0 - x0, ey0 - y0, ex1 - ex0, ey1 - ey0 }, x0, y0);
+		}
+}
+
+const vector<array<int, 4>> &TiledHoughTransform::process(const ImageView<const unsigned char> &image, const int numOfLines,
+	const int fillGap, const int minLength, const HoughTransform::VotingMode mode, const double angleWindow)
+{
+	if (image.width != width || image.height != height)
+		throw invalid_argument("TiledHoughTransform::process: image size differs from the transform");
+
+	lines.clear();
+
+	// thresholds from the edge amplitudes of the whole image, each pixel counted by one tile
+	for (int i = 0; i < 256; i++)
+		hist[i] = 0;
+	forEachTile(image, [&](const Rect &core, const Rect &, const int, const int) { tile.addHistogram(hist, core); });
+	unsigned char high, low;
+	HoughTransform::edgeThresholds(hist, high, low);
+
+	// vote the edges of every tile
+	rThetaM.clear();
+	numOfEdges = 0;
+	forEachTile(image, [&](const Rect &core, const Rect &exact, const int x0, const int y0)
+	{
+		tile.thresholdEdges(high, low, exact);
+		tile.keepEdges(core);
+		tile.voteEdges(rThetaM, x0, y0, mode, angleWindow);
+		numOfEdges += tile.edgeCount();
+	});
+	rThetaM.findPeaks(numOfLines, HoughTransform::peakThetaHood, HoughTransform::peakRhoHood, peaks);
+
+	// collect the edge pixels on the peaks, then sort them into raster order
+	const int rOffset = (rThetaM.nRho - 1) / 2;
+	const double *cosT = trig.cosTable();
+	const double *sinT = trig.sinTable();
+	peakPixels.clear();
+	forEachTile(image, [&](const Rect &core, const Rect &exact, const int x0, const int y0)
+	{
+		tile.thresholdEdges(high, low, exact);
+		tile.keepEdges(core);
+		const EdgeList &edges = tile.edgeList();
+		for (size_t e = 0; e < edges.size(); e++)
+		{
+			const int x = x0 + edges.x[e];
+			const int y = y0 + edges.y[e];
+			for (const auto &p : peaks)
+				if ((int)round(x*cosT[p.a] + y*sinT[p.a]) + rOffset == p.r)
+				{
+					peakPixels.push_back((size_t)y * width + x);
+					break;
+				}
+		}
+	});
+	sort(peakPixels.begin(), peakPixels.end());
+	peakEdges.clear();
+	for (const size_t i : peakPixels)
+		peakEdges.push_back((int)(i % width), (int)(i / width));
+
+	segments.index(peakEdges, peaks, trig, rOffset);
+	segments.extract(peakEdges, fillGap, minLength, 0, 0, lines);
+	return lines;
+}
@@ -0,0 +1,73 @@
+#ifndef _TILEDHOUGHTRANSFORM_H
+#define _TILEDHOUGHTRANSFORM_H
+
+#include <array>
+#include <vector>
+
+#include "EdgeList.h"
+#include "HoughAccumulator.h"
+#include "HoughSegments.h"
+#include "HoughTransform.h"
+#include "Image.h"
+#include "TrigTable.h"
+
+using std::array;
+using std::vector;
+
+// Hough transform of images too large for the planes of a HoughTransform. the image is
+// filtered in tiles of tileSize x tileSize pixels, each with the margin the filters need,
+// and the edges of all tiles vote into one matrix. memory grows with the tile size and the
+// voting matrix, not with the image.
+// the edge amplitudes and thresholds are those of the whole image, but weak edges are only
+// grown from strong ones up to hysteresisMargin pixels outside a tile. the front end runs three
+// times per tile: for the histogram of the thresholds, for voting and for the pixels of the peaks.
+class TiledHoughTransform
+{
+public:
+	TiledHoughTransform(size_t w, size_t h, const size_t tileSize = 1024, const double thetaResolution = 1.0,
+		const HoughAccumulator::Layout layout = HoughAccumulator::ThetaMajor);
+
+	const size_t width;
+	const size_t height;
+
+	void setNumThreads(int n) { tile.setNumThreads(n); }
+	// StreamingFilters can not run the stages of the tiles and throws invalid_argument
+	void setFrontEnd(const HoughTransform::FrontEnd f);
+
+	// bytes of the tile planes, the voting matrices and the pixels of the peaks
+	size_t memoryUsed() const;
+	// number of edge pixels found by the last call of process
+	size_t edgeCount() const { return numOfEdges; }
+
+	// find lines in image, of width x height pixels, see HoughTransform::HoughLines
+	const vector<array<int, 4>> &process(const ImageView<const unsigned char> &image, const int numOfLines = 1,
+		const int fillGap = 20, const int minLength = 40,
+		const HoughTransform::VotingMode mode = HoughTransform::FullVoting, const double angleWindow = 10);
+
+	// lines as [x1, y1, x2, y2] in image coordinates
+	vector<array<int, 4>> lines;
+
+private:
+	// run the front end of every tile, then call f(core, exact, x0, y0) with the part of the
+	// tile it is responsible for, the part where edges can be found exactly and the position
+	// of the tile in the image
+	template <typename F>
+	void forEachTile(const ImageView<const unsigned char> &image, F f);
+
+	static const int hysteresisMargin = 16;
+
+	const int tileSize;
+	HoughTransform tile;		// transform of one tile and its margins
+	const TrigTable trig;
+	HoughAccumulator rThetaM;	// voting matrix of the whole image
+	vector<HoughPeak> peaks;
+
+	vector<size_t> peakPixels;	// raster index of the edge pixels on the peaks
+	EdgeList peakEdges;			// the same pixels in raster order
+	HoughSegments segments;
+
+	unsigned int hist[256];		// histogram of suppressed edge amplitudes of the whole image
+	size_t numOfEdges;
+};
+
+#endif
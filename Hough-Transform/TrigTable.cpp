@@ -0,0 +1,19 @@
+#include <cmath>
+
+#include "TrigTable.h"
+
+using namespace std;
+
+const double pi = 3.14159265;
+
+TrigTable::TrigTable(const double resolution) :
+	size((int)round(180.0 / resolution)), step(180.0 / round(180.0 / resolution))
+{
+	cosT.resize(size);
+	sinT.resize(size);
+	for (int a = 0; a < size; a++)
+	{
+		cosT[a] = cos(theta(a) / 180.0*pi);
+		sinT[a] = sin(theta(a) / 180.0*pi);
+	}
+}
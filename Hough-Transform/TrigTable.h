@@ -0,0 +1,28 @@
+#ifndef _TRIGTABLE_H
+#define _TRIGTABLE_H
+
+#include <vector>
+
+using std::vector;
+
+// cosine and sine of every theta bin of the Hough transform matrix.
+// computed once so the voting and back-projection loops are free of trigonometric calls.
+// theta bin a corresponds to angle -90 + a * step degrees, a = 0 : size - 1
+class TrigTable
+{
+public:
+	TrigTable(const double resolution = 1.0);
+
+	const int size;		// number of theta bins covering [-90, 90)
+	const double step;	// angle between two neighbouring bins in degrees
+
+	double theta(const int a) const { return -90.0 + a * step; }
+	const double *cosTable() const { return cosT.data(); }
+	const double *sinTable() const { return sinT.data(); }
+
+private:
+	vector<double> cosT;
+	vector<double> sinT;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "WorkerPool.h"
+
+using namespace std;
+
+WorkerPool::WorkerPool(const int numOfThreads) :
+	taskFn(nullptr), taskCtx(nullptr), taskCount(0), next(0), running(0), generation(0), stop(false)
+{
+	for (int i = 1; i < numOfThreads; i++)
+		threads.emplace_back(&WorkerPool::loop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		lock_guard<mutex> lock(m);
+		stop = true;
+	}
+	wake.notify_all();
+	for (auto &t : threads)
+		t.join();
+}
+
+void WorkerPool::run(const int count, void(*fn)(void *, const int), void *ctx)
+{
+	if (threads.empty() || count <= 1)
+	{
+		for (int i = 0; i < count; i++)
+			fn(ctx, i);
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(m);
+		taskFn = fn;
+		taskCtx = ctx;
+		taskCount = count;
+		next = 0;
+		running = (int)threads.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	// the calling thread works as well
+	work();
+
+	unique_lock<mutex> lock(m);
+	done.wait(lock, [this] { return running == 0; });
+}
+
+void WorkerPool::work()
+{
+	int i;
+	while ((i = next++) < taskCount)
+		taskFn(taskCtx, i);
+}
+
+void WorkerPool::loop()
+{
+	unsigned seen = 0;
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m);
+			wake.wait(lock, [&] { return stop || generation != seen; });
+			if (stop)
+				return;
+			seen = generation;
+		}
+
+		work();
+
+		lock_guard<mutex> lock(m);
+		if (--running == 0)
+			done.notify_one();
+	}
+}
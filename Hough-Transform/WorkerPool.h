@@ -0,0 +1,57 @@
+#ifndef _WORKERPOOL_H
+#define _WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+// fixed set of threads running parallel loops. the threads are started once and
+// sleep between loops, so a parallel loop costs no thread creation or allocation.
+class WorkerPool
+{
+public:
+	// numOfThreads includes the calling thread, so numOfThreads - 1 threads are started
+	WorkerPool(const int numOfThreads);
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	~WorkerPool();
+
+	int size() const { return (int)threads.size() + 1; }
+
+	// call task(i) for i = 0 : count - 1 on all threads and return when every call finished
+	template <typename F>
+	void parallelFor(const int count, F &task)
+	{
+		run(count, &invoke<F>, &task);
+	}
+
+private:
+	template <typename F>
+	static void invoke(void *task, const int i)
+	{
+		(*(F *)task)(i);
+	}
+
+	void run(const int count, void(*fn)(void *, const int), void *ctx);
+	void work();	// take tasks of the current loop until none are left
+	void loop();	// body of the pool threads
+
+	vector<std::thread> threads;
+	std::mutex m;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	void(*taskFn)(void *, const int);
+	void *taskCtx;
+	int taskCount;
+	std::atomic<int> next;	// next task index to hand out
+	int running;			// pool threads not yet finished with the current loop
+	unsigned generation;	// incremented for every loop
+	bool stop;
+};
+
+#endif
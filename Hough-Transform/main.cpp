@@ -1,52 +1,438 @@
-#include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
+// the window of --show needs a display, so it is only built with HOUGH_DISPLAY
+#ifndef HOUGH_DISPLAY
+#define cimg_display 0
+#endif
 #include "CImg.h"
 #include "Image.h"
 #include "HoughTransform.h"
+#include "MappedImage.h"
 
 using namespace std;
 using namespace cimg_library;
+namespace fs = std::filesystem;
+
+static const char *usage =
+	"usage: Hough-Transform [options] [image or directory ...]\n"
+	"finds line segments in every image, house.bmp without arguments. directories are\n"
+	"searched for .bmp, .pgm, .ppm and .pnm files.\n"
+	"  --list file             also read image paths from file, one per line\n"
+	"  --lines n               lines searched for per image (10)\n"
+	"  --fill-gap n            gaps shorter than n pixels are closed (5)\n"
+	"  --min-length n          shorter segments are dropped (60)\n"
+	"  --mode full|gradient    voting mode (full)\n"
+	"  --angle-window degrees  gradient voting window (10)\n"
+	"  --theta-resolution deg  angle between theta bins (1)\n"
+	"  --front-end reference|fused|integer|streaming (fused)\n"
+	"  --threads n             voting threads, 0 for all (1)\n"
+	"  --format csv|json|binary (csv)\n"
+	"  --output file           write to file instead of stdout\n"
+#ifdef HOUGH_DISPLAY
+	"  --show                  draw the lines of every image in a window\n"
+#endif
+	;
+
+// options of the command line
+struct Options
+{
+	vector<string> files;
+	int numOfLines = 10;
+	int fillGap = 5;
+	int minLength = 60;
+	HoughTransform::VotingMode mode = HoughTransform::FullVoting;
+	double angleWindow = 10;
+	double thetaResolution = 1.0;
+	HoughTransform::FrontEnd frontEnd = HoughTransform::FusedFilters;
+	int threads = 1;
+	string format = "csv";
+	string output;
+	bool show = false;
+};
+
+// an image read from file. 8-bit gray PGM and BMP files are mapped and read in place,
+// other files are decoded by CImg and converted to gray.
+struct Decoded
+{
+	unique_ptr<MappedImage> mapped;
+	CImg<unsigned char> gray;
+	ImageView<const unsigned char> view;
+	string error;
+};
+
+static bool isImage(const fs::path &path)
+{
+	string ext = path.extension().string();
+	transform(ext.begin(), ext.end(), ext.begin(), [](const char c) { return (char)tolower((unsigned char)c); });
+	return ext == ".bmp" || ext == ".pgm" || ext == ".ppm" || ext == ".pnm";
+}
+
+// add path to files, or the images in it sorted by name if it is a directory
+static void addInput(const string &path, vector<string> &files)
+{
+	error_code ec;
+	if (!fs::is_directory(path, ec))
+	{
+		files.push_back(path);
+		return;
+	}
+
+	vector<string> found;
+	for (const auto &entry : fs::directory_iterator(path, ec))
+		if (entry.is_regular_file(ec) && isImage(entry.path()))
+			found.push_back(entry.path().string());
+	sort(found.begin(), found.end());
+	files.insert(files.end(), found.begin(), found.end());
+}
+
+static bool parse(int argc, char *argv[], Options &o)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const string arg = argv[i];
+		if (arg == "--help" || arg == "-h")
+		{
+			cout << usage;
+			exit(0);
+		}
+		if (arg == "--show")
+		{
+#ifdef HOUGH_DISPLAY
+			o.show = true;
+			continue;
+#else
+			cerr << "--show needs a build with HOUGH_DISPLAY" << endl;
+			return false;
+#endif
+		}
+		if (arg.compare(0, 2, "--") != 0)
+		{
+			addInput(arg, o.files);
+			continue;
+		}
+		if (i + 1 == argc)
+		{
+			cerr << "missing value of " << arg << endl;
+			return false;
+		}
+
+		const string value = argv[++i];
+		if (arg == "--list")
+		{
+			ifstream list(value);
+			if (!list)
+			{
+				cerr << "can not read " << value << endl;
+				return false;
+			}
+			string line;
+			while (getline(list, line))
+				if (!line.empty())
+					addInput(line, o.files);
+		}
+		else if (arg == "--lines")
+			o.numOfLines = atoi(value.c_str());
+		else if (arg == "--fill-gap")
+			o.fillGap = atoi(value.c_str());
+		else if (arg == "--min-length")
+			o.minLength = atoi(value.c_str());
+		else if (arg == "--mode" && (value == "full" || value == "gradient"))
+			o.mode = value == "full" ? HoughTransform::FullVoting : HoughTransform::GradientVoting;
+		else if (arg == "--angle-window")
+			o.angleWindow = atof(value.c_str());
+		else if (arg == "--theta-resolution")
+			o.thetaResolution = atof(value.c_str());
+		else if (arg == "--front-end" && value == "reference")
+			o.frontEnd = HoughTransform::ReferenceFilters;
+		else if (arg == "--front-end" && value == "fused")
+			o.frontEnd = HoughTransform::FusedFilters;
+		else if (arg == "--front-end" && value == "integer")
+			o.frontEnd = HoughTransform::IntegerFilters;
+		else if (arg == "--front-end" && value == "streaming")
+			o.frontEnd = HoughTransform::StreamingFilters;
+		else if (arg == "--threads")
+			o.threads = atoi(value.c_str());
+		else if (arg == "--format" && (value == "csv" || value == "json" || value == "binary"))
+			o.format = value;
+		else if (arg == "--output")
+			o.output = value;
+		else
+		{
+			cerr << "unknown option " << arg << " " << value << endl << usage;
+			return false;
+		}
+	}
+
+	if (o.thetaResolution <= 0)
+	{
+		cerr << "--theta-resolution must be positive" << endl;
+		return false;
+	}
+	if (o.files.empty())
+		o.files.push_back("house.bmp");
+	return true;
+}
+
+static Decoded decode(const string &path)
+{
+	Decoded d;
+	try
+	{
+		d.mapped = MappedImage::open(path);
+	}
+	catch (const exception &e)
+	{
+		d.error = e.what();
+		return d;
+	}
+	if (d.mapped)
+	{
+		d.view = d.mapped->view();
+		return d;
+	}
+
+	try
+	{
+		CImg<unsigned char> img(path.c_str());
+		if (img.spectrum() >= 3)
+		{
+			// luma of colour images, gray pixels keep their value
+			d.gray.assign(img.width(), img.height());
+			cimg_forXY(d.gray, x, y)
+				d.gray(x, y) = (unsigned char)((299 * img(x, y, 0, 0) + 587 * img(x, y, 0, 1) + 114 * img(x, y, 0, 2) + 500) / 1000);
+		}
+		else
+			d.gray = img.get_channel(0);
+		d.view = ImageView<const unsigned char>(d.gray.data(), d.gray.width(), d.gray.height());
+	}
+	catch (const CImgException &)
+	{
+		d.error = "can not read " + path;
+	}
+	return d;
+}
+
+// writes the segments of every image as CSV, JSON or binary records
+class Writer
+{
+public:
+	Writer(ostream &out, const string &format) : out(out), format(format), count(0)
+	{
+		if (format == "csv")
+			out << "file,width,height,x1,y1,x2,y2\n";
+		else if (format == "json")
+			out << "[";
+		else
+		{
+			// binary stream: "HGLN", uint32 version, then one record per image of uint32 path length,
+			// path, uint32 width, height and number of lines, and int32 x1, y1, x2, y2 per line.
+			// all integers are little endian.
+			out.write("HGLN", 4);
+			put(1);
+		}
+	}
+
+	~Writer()
+	{
+		if (format == "json")
+			out << (count > 0 ? "\n]\n" : "]\n");
+		out.flush();
+	}
+
+	void write(const string &file, const size_t width, const size_t height, const double seconds,
+		const vector<array<int, 4>> &lines)
+	{
+		if (format == "csv")
+		{
+			for (const auto &L : lines)
+				out << quoted(file, ',') << "," << width << "," << height << ","
+					<< L[0] << "," << L[1] << "," << L[2] << "," << L[3] << "\n";
+		}
+		else if (format == "json")
+		{
+			out << (count > 0 ? ",\n" : "\n") << "  {\"file\": \"" << escaped(file) << "\", \"width\": " << width
+				<< ", \"height\": " << height << ", \"seconds\": " << seconds << ", \"lines\": [";
+			for (size_t i = 0; i < lines.size(); i++)
+			{
+				const auto &L = lines[i];
+				out << (i > 0 ? ", " : "") << "[" << L[0] << ", " << L[1] << ", " << L[2] << ", " << L[3] << "]";
+			}
+			out << "]}";
+		}
+		else
+		{
+			put((uint32_t)file.size());
+			out.write(file.data(), file.size());
+			put((uint32_t)width);
+			put((uint32_t)height);
+			put((uint32_t)lines.size());
+			for (const auto &L : lines)
+				for (const int v : L)
+					put((uint32_t)v);
+		}
+		count++;
+	}
+
+private:
+	void put(const uint32_t v)
+	{
+		const char bytes[4] = { (char)(v & 0xff), (char)((v >> 8) & 0xff), (char)((v >> 16) & 0xff), (char)(v >> 24) };
+		out.write(bytes, 4);
+	}
+
+	// file names with the separator or quotes are quoted for CSV
+	static string quoted(const string &s, const char separator)
+	{
+		if (s.find(separator) == string::npos && s.find('"') == string::npos)
+			return s;
+		string q = "\"";
+		for (const char c : s)
+			q += c == '"' ? string("\"\"") : string(1, c);
+		return q + "\"";
+	}
+
+	static string escaped(const string &s)
+	{
+		string e;
+		for (const char c : s)
+		{
+			if (c == '"' || c == '\\')
+				e += '\\';
+			e += c;
+		}
+		return e;
+	}
+
+	ostream &out;
+	const string format;
+	size_t count;
+};
+
+int main(int argc, char *argv[])
+{
+	// unreadable images are reported by decode, not by CImg
+	cimg::exception_mode(0);
+
+	Options o;
+	if (!parse(argc, argv, o))
+		return 2;
+
+	ofstream file;
+	if (!o.output.empty())
+	{
+		file.open(o.output, o.format == "binary" ? ios::out | ios::binary : ios::out);
+		if (!file)
+		{
+			cerr << "can not write " << o.output << endl;
+			return 2;
+		}
+	}
+	else if (o.format == "binary")
+	{
+		cerr << "binary output needs --output" << endl;
+		return 2;
+	}
+
+	int failed = 0;
+	const auto start = chrono::steady_clock::now();
+	{
+		Writer writer(o.output.empty() ? cout : file, o.format);
+
+		// the transform is kept while the image size does not change
+		unique_ptr<HoughTransform> H;
+
+		// image i + 1 is decoded while lines are found in image i
+		future<Decoded> next = async(launch::async, decode, o.files[0]);
+		for (size_t i = 0; i < o.files.size(); i++)
+		{
+			Decoded d = next.get();
+			if (i + 1 < o.files.size())
+				next = async(launch::async, decode, o.files[i + 1]);
+
+			if (!d.error.empty())
+			{
+				cerr << d.error << endl;
+				failed++;
+				continue;
+			}
+
+			const size_t w = d.view.width;
+			const size_t h = d.view.height;
+			const vector<array<int, 4>> *found;
+			chrono::duration<double> elapsed;
+			try
+			{
+				if (!H || H->width != w || H->height != h)
+				{
+					H.reset();
+					H.reset(new HoughTransform(w, h, o.thetaResolution));
+					H->setNumThreads(o.threads);
+					H->setFrontEnd(o.frontEnd);
+				}
+
+				const auto t0 = chrono::steady_clock::now();
+				found = &H->process(d.view, o.numOfLines, o.fillGap, o.minLength, o.mode, o.angleWindow);
+				elapsed = chrono::steady_clock::now() - t0;
+			}
+			catch (const exception &e)
+			{
+				// one image the transform can not process, e.g. too large, does not stop the others.
+				// the transform may be left half-updated, so the next image gets a new one
+				cerr << o.files[i] << ": " << e.what() << endl;
+				H.reset();
+				failed++;
+				continue;
+			}
+			const vector<array<int, 4>> &lines = *found;
+			writer.write(o.files[i], w, h, elapsed.count(), lines);
+
+#ifdef HOUGH_STATS
+			// time and counters of every stage
+			const HoughStats &stats = H->stageStats();
+			cerr << o.files[i] << ": filter " << stats.filterSeconds << " (gaussian " << stats.gaussianSeconds << ")"
+				<< ", suppression " << stats.suppressionSeconds << ", threshold " << stats.thresholdSeconds
+				<< ", vote " << stats.voteSeconds << ", peaks " << stats.peakSeconds
+				<< ", segments " << stats.segmentSeconds << ", total " << stats.totalSeconds << endl;
+			cerr << stats.edges << " edges, " << stats.votes << " votes, accumulator max " << stats.accumulatorMax
+				<< ", " << stats.peaks << " peaks with";
+			for (const int n : stats.peakPixels)
+				cerr << " " << n;
+			cerr << " pixels" << endl;
+#endif
+
+#ifdef HOUGH_DISPLAY
+			if (o.show)
+			{
+				// draw lines on image
+				CImg<unsigned char> img((unsigned)w, (unsigned)h, 1, 3);
+				cimg_forXYC(img, x, y, c)
+					img(x, y, 0, c) = d.view(x, y);
+				const unsigned char color[3] = { 0, 255, 0 };
+				for (const auto &L : lines)
+					img.draw_line(L[0], L[1], L[2], L[3], color, 1.0f);
+
+				CImgDisplay disp(img, o.files[i].c_str());
+				while (!disp.is_closed())
+					disp.wait();
+			}
+#endif
+		}
+	}
 
-int main()
-{
-	
-	CImg<unsigned char> img("house.bmp");
-	
-	size_t h = img.height();
-	size_t w = img.width();
-	
-	// Record start time
-	auto start = std::chrono::high_resolution_clock::now();
-
-	unsigned char *imageArray = img.data();
-	
-	HoughTransform H(w,h);
-	H.img = imageArray;
-
-	H.HoughLines(10, 5, 60);
-	
-	// Record end time
-	auto finish = std::chrono::high_resolution_clock::now();
-	std::chrono::duration<double> elapsed = finish - start;
-	std::cout << "Elapsed time: " << elapsed.count() << endl;
-	
-	// draw lines on image
-	const unsigned char color[3] = { 0, 255, 0 };
-	for (const auto L : H.lines)
-	{
-		cout << L[0] << " " << L[1] << " " << L[2] << " " << L[3] << endl; // cout coordinates of line segments
-		img.draw_line(L[0], L[1], L[2], L[3], color, 1.0f);  // wish the draw_line function has a parameter to change line width
-	}
-	
-	// display images	
-	CImgDisplay src_disp(img, "source");
-
-	while (!src_disp.is_closed())
-	{
-		src_disp.wait();
-	}
-	
-	
-	return 0;
-}
\ No newline at end of file
+	const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	cerr << o.files.size() - failed << " images in " << elapsed.count() << " s";
+	if (failed > 0)
+		cerr << ", " << failed << " failed";
+	cerr << endl;
+	return failed > 0 ? 1 : 0;
+}